@@ -0,0 +1,25 @@
+# cmake -DSTRESS_TESTS=<exe> -DPGO_DIR=<dir> [-DLLVM_PROFDATA=<exe>] [-DSCALE=<n>] -P PGOTrain.cmake
+# Runs the stress corpus under a SHADER_CROSS_PGO=GENERATE build to collect profiles.
+
+if (NOT SCALE)
+    set(SCALE 1)
+endif()
+set(ENV{SHADER_CROSS_STRESS_SCALE} ${SCALE})
+# Clang writes one .profraw per process, the merged file is what USE reads
+file(GLOB staleProfiles "${PGO_DIR}/*.profraw")
+if (staleProfiles)
+    file(REMOVE ${staleProfiles})
+endif()
+execute_process(COMMAND "${STRESS_TESTS}" RESULT_VARIABLE result)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "Training run failed: ${result}")
+endif()
+
+if (LLVM_PROFDATA)
+    file(GLOB profiles "${PGO_DIR}/*.profraw")
+    execute_process(COMMAND "${LLVM_PROFDATA}" merge -output=${PGO_DIR}/default.profdata ${profiles} RESULT_VARIABLE result)
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "llvm-profdata merge failed: ${result}")
+    endif()
+endif()
+message(STATUS "Profiles written to ${PGO_DIR}, reconfigure with -DSHADER_CROSS_PGO=USE and rebuild")
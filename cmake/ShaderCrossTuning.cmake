@@ -0,0 +1,66 @@
+# Release tuning shared by shader-cross and the fetched dependencies, so it must be
+# included before they are added.
+
+set(SHADER_CROSS_CMAKE_DIR "${CMAKE_CURRENT_LIST_DIR}")
+
+# The dependencies require CMake versions older than these policies: without the
+# defaults they ignore CMAKE_INTERPROCEDURAL_OPTIMIZATION and let option() drop
+# the variables set here.
+set(CMAKE_POLICY_DEFAULT_CMP0069 NEW)
+set(CMAKE_POLICY_DEFAULT_CMP0077 NEW)
+
+if (SHADER_CROSS_LTO)
+    include(CheckIPOSupported)
+    check_ipo_supported(RESULT ipoSupported OUTPUT ipoOutput)
+    if (ipoSupported)
+        set(CMAKE_INTERPROCEDURAL_OPTIMIZATION ON)
+    else()
+        message(WARNING "LTO not supported: ${ipoOutput}")
+    endif()
+endif()
+
+if (SHADER_CROSS_PGO)
+    string(TOUPPER "${SHADER_CROSS_PGO}" pgoMode)
+    if (CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        # GCC names profiles after object paths: GENERATE and USE must share a build directory.
+        # Counters are updated atomically since the training corpus is compiled by several threads.
+        if (pgoMode STREQUAL "GENERATE")
+            set(pgoFlags "-fprofile-generate=${SHADER_CROSS_PGO_DIR} -fprofile-update=atomic")
+        elseif (pgoMode STREQUAL "USE")
+            set(pgoFlags "-fprofile-use=${SHADER_CROSS_PGO_DIR} -fprofile-correction -Wno-missing-profile")
+        endif()
+    elseif (CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+        if (pgoMode STREQUAL "GENERATE")
+            set(pgoFlags "-fprofile-generate=${SHADER_CROSS_PGO_DIR}")
+        elseif (pgoMode STREQUAL "USE")
+            set(pgoFlags "-fprofile-use=${SHADER_CROSS_PGO_DIR}/default.profdata -Wno-profile-instr-unprofiled")
+        endif()
+        find_program(SHADER_CROSS_LLVM_PROFDATA NAMES llvm-profdata)
+    else()
+        message(WARNING "PGO not supported with ${CMAKE_CXX_COMPILER_ID}")
+    endif()
+    if (NOT pgoFlags AND NOT pgoMode MATCHES "^(GENERATE|USE)$")
+        message(FATAL_ERROR "SHADER_CROSS_PGO must be GENERATE or USE, not '${SHADER_CROSS_PGO}'")
+    endif()
+    if (pgoFlags)
+        set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} ${pgoFlags}")
+        set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} ${pgoFlags}")
+        set(CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} ${pgoFlags}")
+        set(CMAKE_SHARED_LINKER_FLAGS "${CMAKE_SHARED_LINKER_FLAGS} ${pgoFlags}")
+    endif()
+endif()
+
+if (SHADER_CROSS_STATIC_SHADERX)
+    # Not cached, so turning the option off restores the user's settings
+    set(BUILD_SHARED_LIBS OFF)
+    if (MSVC)
+        # Static CRT everywhere so shaderx doesn't depend on the runtime DLLs
+        set(gtest_force_shared_crt OFF)
+        foreach (flags CMAKE_C_FLAGS CMAKE_C_FLAGS_DEBUG CMAKE_C_FLAGS_RELEASE CMAKE_C_FLAGS_RELWITHDEBINFO CMAKE_C_FLAGS_MINSIZEREL
+                CMAKE_CXX_FLAGS CMAKE_CXX_FLAGS_DEBUG CMAKE_CXX_FLAGS_RELEASE CMAKE_CXX_FLAGS_RELWITHDEBINFO CMAKE_CXX_FLAGS_MINSIZEREL)
+            string(REPLACE "/MD" "/MT" ${flags} "${${flags}}")
+        endforeach()
+    elseif (APPLE)
+        message(WARNING "Fully static executables are not supported on macOS, linking libstdc++/libc++ dynamically")
+    endif()
+endif()
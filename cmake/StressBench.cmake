@@ -0,0 +1,65 @@
+# cmake -DSTRESS_TESTS=<exe> [-DBASELINE=<exe>] [-DSCALE=<n>] -P StressBench.cmake
+# Reports corpus throughput of this build and, given the stress_tests of an untuned
+# build, the speedup of the tuning options.
+
+if (NOT SCALE)
+    set(SCALE 1)
+endif()
+set(ENV{SHADER_CROSS_STRESS_SCALE} ${SCALE})
+
+# shaders/s in thousandths, cmake math is integer only
+function(RunCorpus exe singleVar multiVar)
+    execute_process(COMMAND "${exe}" --gtest_filter=StressTest.ThreadScaling
+        OUTPUT_VARIABLE output RESULT_VARIABLE result)
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "${exe} failed: ${result}\n${output}")
+    endif()
+    string(REGEX MATCHALL "threads=[0-9]+ shaders/s=[0-9]+\\.?[0-9]*" lines "${output}")
+    if (NOT lines)
+        message(FATAL_ERROR "No throughput reported by ${exe}")
+    endif()
+    set(multi 0)
+    foreach (line ${lines})
+        string(REGEX REPLACE "threads=([0-9]+) shaders/s=([0-9]+)\\.?([0-9]*)" "\\1;\\2;\\3" fields "${line}")
+        list(GET fields 0 threads)
+        list(GET fields 1 whole)
+        list(GET fields 2 fraction)
+        string(SUBSTRING "${fraction}000" 0 3 fraction)
+        string(REGEX REPLACE "^0+([0-9])" "\\1" fraction "${fraction}")
+        math(EXPR milli "${whole} * 1000 + ${fraction}")
+        if (threads EQUAL 1)
+            set(single ${milli})
+        endif()
+        set(multi ${milli})
+    endforeach()
+    set(${singleVar} ${single} PARENT_SCOPE)
+    set(${multiVar} ${multi} PARENT_SCOPE)
+endfunction()
+
+function(FormatMilli milli var)
+    math(EXPR whole "${milli} / 1000")
+    math(EXPR fraction "${milli} % 1000")
+    string(LENGTH "${fraction}" length)
+    while (length LESS 3)
+        set(fraction "0${fraction}")
+        string(LENGTH "${fraction}" length)
+    endwhile()
+    set(${var} "${whole}.${fraction}" PARENT_SCOPE)
+endfunction()
+
+RunCorpus("${STRESS_TESTS}" single multi)
+FormatMilli(${single} singleText)
+FormatMilli(${multi} multiText)
+message(STATUS "tuned:    shaders/s=${singleText} (1 thread) ${multiText} (all threads)")
+
+if (BASELINE)
+    RunCorpus("${BASELINE}" baseSingle baseMulti)
+    FormatMilli(${baseSingle} baseSingleText)
+    FormatMilli(${baseMulti} baseMultiText)
+    message(STATUS "baseline: shaders/s=${baseSingleText} (1 thread) ${baseMultiText} (all threads)")
+    math(EXPR singleSpeedup "${single} * 1000 / ${baseSingle}")
+    math(EXPR multiSpeedup "${multi} * 1000 / ${baseMulti}")
+    FormatMilli(${singleSpeedup} singleSpeedupText)
+    FormatMilli(${multiSpeedup} multiSpeedupText)
+    message(STATUS "speedup:  ${singleSpeedupText}x (1 thread) ${multiSpeedupText}x (all threads)")
+endif()
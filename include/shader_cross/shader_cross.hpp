@@ -2,11 +2,13 @@
 #define SHADER_CROSS_H
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 #include <string>
 
 namespace glslang {
 class TShader;
+class TProgram;
 } // namespace glslang
 
 namespace spirv_cross {
@@ -25,20 +27,43 @@ enum class Stage {
     Compute,
 };
 
+struct DescriptorRemap {
+    std::uint32_t Set = 0;
+    std::uint32_t Binding = 0;
+    std::uint32_t NewSet = 0;
+    std::uint32_t NewBinding = 0;
+};
+
+struct LocationRemap {
+    // Stage output instead of stage input
+    bool Output = false;
+    std::uint32_t Location = 0;
+    std::uint32_t NewLocation = 0;
+};
+
+struct RemapOptions {
+    std::vector<DescriptorRemap> Descriptors;
+    std::vector<LocationRemap> Locations;
+};
+
 struct GLSLOptions {
     int Version = 450;
+    RemapOptions Remap;
 };
 
 struct ESSLOptions {
     int Version = 320;
+    RemapOptions Remap;
 };
 
 struct SPIRVOptions {
     int Version = 13;
+    RemapOptions Remap;
 };
 
 struct HLSLOptions {
     int Model = 60;
+    RemapOptions Remap;
 };
 
 enum class MSLPlatform {
@@ -50,21 +75,44 @@ enum class MSLPlatform {
 struct MSLOptions {
     MSLPlatform Platform = MSLPlatform::OSX;
     int Version = 120;
+    RemapOptions Remap;
 };
 
+// Rewrites DescriptorSet/Binding decorations and the Location decorations of stage
+// input/output variables and of their block members in place, in a single scan of the
+// module. Resources without a DescriptorSet decoration are in set 0 and can only be
+// remapped within it. Fails without touching the module when a remapped decoration comes
+// from a decoration group or a block type shared by stage input and output.
+bool RemapSPIRV(std::uint32_t* spirv, std::size_t size, const RemapOptions& opts, std::string* log);
+
+bool RemapSPIRV(std::vector<std::uint32_t>* spirv, const RemapOptions& opts, std::string* log);
+
 class SPIRVIR;
+class PreprocessCache;
 
 class GLSLAST {
 public:
     struct Options {
-        Stage Stage = Stage::None;
+        shader_cross::Stage Stage = shader_cross::Stage::None;
         int DefaultVersion = 450;
         std::string EntryPoint = "main";
         bool EnableInclude = true;
         std::vector<std::string> Names;
         std::vector<std::string> IncludeDirectories;
+        // "NAME" or "NAME=VALUE"
+        std::vector<std::string> Defines;
+        // Sources are Preprocess output: includes, defines and the preamble are already applied
+        bool Preprocessed = false;
+        // Parse the cached preprocessed output instead of the sources
+        shader_cross::PreprocessCache* PreprocessCache = nullptr;
     };
 
+    static bool Preprocess(const char** glsls, const std::size_t* sizes, int num, const Options& opts, std::string* output, std::string* log);
+
+    static bool Preprocess(const std::string* glsls, int num, const Options& opts, std::string* output, std::string* log);
+
+    static bool Preprocess(const std::vector<std::string>& glsls, const Options& opts, std::string* output, std::string* log);
+
     bool Parse(const char** glsls, const std::size_t* sizes, int num, const Options& opts, std::string* log);
 
     bool Parse(const std::string* glsls, int num, const Options& opts, std::string* log);
@@ -73,32 +121,137 @@ public:
 
     bool ToSPIRV(std::vector<std::uint32_t>* spirv, const SPIRVOptions& opts, std::string* log) const;
 
+    // Frees the AST; call once ToSPIRV is done
+    void Release();
+
+private:
+    struct TShaderDeleter {
+        void operator()(glslang::TShader* shader);
+    };
+    std::unique_ptr<glslang::TShader, TShaderDeleter> shader;
+};
+
+class HLSLAST {
+public:
+    struct Options {
+        shader_cross::Stage Stage = shader_cross::Stage::None;
+        // Defines __SHADER_TARGET_MAJOR and __SHADER_TARGET_MINOR
+        int ShaderModel = 50;
+        std::string EntryPoint = "main";
+        bool EnableInclude = true;
+        std::vector<std::string> Names;
+        std::vector<std::string> IncludeDirectories;
+        // "NAME" or "NAME=VALUE"
+        std::vector<std::string> Defines;
+        // Register mapping: register(x#, space#) maps to binding # + shift, set #
+        bool HlslIoMapping = true;
+        bool AutoMapBindings = false;
+        unsigned int ShiftSamplerBinding = 0;
+        unsigned int ShiftTextureBinding = 0;
+        unsigned int ShiftConstantBufferBinding = 0;
+        unsigned int ShiftUAVBinding = 0;
+        // Sources are Preprocess output: includes, defines and the preamble are already applied
+        bool Preprocessed = false;
+        // Parse the cached preprocessed output instead of the sources
+        shader_cross::PreprocessCache* PreprocessCache = nullptr;
+    };
+
+    static bool Preprocess(const char** hlsls, const std::size_t* sizes, int num, const Options& opts, std::string* output, std::string* log);
+
+    static bool Preprocess(const std::string* hlsls, int num, const Options& opts, std::string* output, std::string* log);
+
+    static bool Preprocess(const std::vector<std::string>& hlsls, const Options& opts, std::string* output, std::string* log);
+
+    bool Parse(const char** hlsls, const std::size_t* sizes, int num, const Options& opts, std::string* log);
+
+    bool Parse(const std::string* hlsls, int num, const Options& opts, std::string* log);
+
+    bool Parse(const std::vector<std::string>& hlsls, const Options& opts, std::string* log);
+
+    bool ToSPIRV(std::vector<std::uint32_t>* spirv, const SPIRVOptions& opts, std::string* log) const;
+
+    // Frees the AST and linked program; call once ToSPIRV is done
+    void Release();
+
 private:
     struct TShaderDeleter {
         void operator()(glslang::TShader* shader);
     };
+    struct TProgramDeleter {
+        void operator()(glslang::TProgram* program);
+    };
+    Stage stage = Stage::None;
     std::unique_ptr<glslang::TShader, TShaderDeleter> shader;
+    // Linked for register mapping; references shader
+    std::unique_ptr<glslang::TProgram, TProgramDeleter> program;
+};
+
+// Thread-safe cache of whole translation unit expansions, keyed by sources, names, defines
+// and include directories, that GLSLAST/HLSLAST::Parse consume. A unit compiled several
+// times with one define set (an AST per target, repeated batches) is preprocessed once.
+// Single headers aren't cached: their expansion depends on the macros defined before each
+// #include. Included files are assumed not to change while cached.
+class PreprocessCache {
+public:
+    // Least recently used expansions are dropped past maxBytes, keys included; 0 is unbounded
+    explicit PreprocessCache(std::size_t maxBytes = 0);
+
+    bool Preprocess(const char** glsls, const std::size_t* sizes, int num, const GLSLAST::Options& opts, std::string* output, std::string* log);
+
+    bool Preprocess(const std::vector<std::string>& glsls, const GLSLAST::Options& opts, std::string* output, std::string* log);
+
+    bool Preprocess(const char** hlsls, const std::size_t* sizes, int num, const HLSLAST::Options& opts, std::string* output, std::string* log);
+
+    bool Preprocess(const std::vector<std::string>& hlsls, const HLSLAST::Options& opts, std::string* output, std::string* log);
+
+    std::size_t Size() const;
+
+    std::size_t Bytes() const;
+
+    void Clear();
+
+private:
+    struct Impl;
+    struct ImplDeleter {
+        void operator()(Impl* impl);
+    };
+    std::unique_ptr<Impl, ImplDeleter> impl;
 };
 
 class SPIRVIR {
 public:
+    struct Options {
+        // When false the first To* moves the IR into its compiler instead of copying it
+        // and frees it with the compiler: lower peak memory, one backend per Parse.
+        bool RetainIR = true;
+    };
+
+    bool Parse(const std::uint32_t* data, std::size_t size, const Options& opts, std::string* log);
+
     bool Parse(const std::uint32_t* data, std::size_t size, std::string* log);
 
+    bool Parse(std::vector<std::uint32_t>&& spirv, const Options& opts, std::string* log);
+
     bool Parse(const std::vector<std::uint32_t>& spirv, std::string* log);
 
-    bool ToGLSL(std::string* glsl, const GLSLOptions& opts, std::string* log) const;
+    // Not const: consumes the IR when !Options::RetainIR
+    bool ToGLSL(std::string* glsl, const GLSLOptions& opts, std::string* log);
+
+    bool ToESSL(std::string* essl, const ESSLOptions& opts, std::string* log);
 
-    bool ToESSL(std::string* essl, const ESSLOptions& opts, std::string* log) const;
+    bool ToHLSL(std::string* hlsl, const HLSLOptions& opts, std::string* log);
 
-    bool ToHLSL(std::string* hlsl, const HLSLOptions& opts, std::string* log) const;
+    bool ToMSL(std::string* msl, const MSLOptions& opts, std::string* log);
 
-    bool ToMSL(std::string* msl, const MSLOptions& opts, std::string* log) const;
+    // Frees the IR
+    void Release();
 
 private:
     struct ParserDeleter {
         void operator()(spirv_cross::Parser* parser);
     };
     std::unique_ptr<spirv_cross::Parser, ParserDeleter> parser;
+    bool retainIR = true;
 };
 
 } // shader_cross
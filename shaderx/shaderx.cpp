@@ -2,6 +2,15 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 #ifdef _MSC_VER
 __pragma(warning(push))
@@ -23,10 +32,24 @@ void initOptions() {
     addOpt("inputs", "", cxxopts::value<std::vector<std::string>>());
     addOpt("S,stage", "Shader stage: vs, tc, te, fs, gs, cs", cxxopts::value<std::string>()->default_value(""), "<stage>");
     addOpt("O,output", "Write output to <file>", cxxopts::value<std::string>()->default_value("-"), "<file>");
-    addOpt("F,from", "From language: glsl, spirv", cxxopts::value<std::string>()->default_value("glsl"), "<lang>");
+    addOpt("F,from", "From language: glsl, hlsl, spirv", cxxopts::value<std::string>()->default_value("glsl"), "<lang>");
     addOpt("T,target", "Target language: spirv, glsl, essl, hlsl, msl", cxxopts::value<std::string>()->default_value("spirv"), "<lang>");
     addOpt("V,version", "Target language version", cxxopts::value<std::string>()->default_value(""), "<ver>");
     addOpt("I,include", "Add directory to include search path", cxxopts::value<std::vector<std::string>>(), "<dir>");
+    addOpt("D,define", "Define <macro> or <macro>=<value>", cxxopts::value<std::vector<std::string>>(), "<macro>");
+    addOpt("E,preprocess", "Only run the preprocessor");
+    addOpt("e,entry", "Entry point name", cxxopts::value<std::string>()->default_value("main"), "<name>");
+    addOpt("shader-model", "HLSL source shader model", cxxopts::value<std::string>()->default_value("50"), "<model>");
+    addOpt("shift-binding", "HLSL register class s, t, b or u binding shift", cxxopts::value<std::vector<std::string>>(), "<class>=<n>");
+    addOpt("auto-map-bindings", "Automatically assign HLSL bindings");
+    addOpt("remap-binding", "Move descriptor set/binding", cxxopts::value<std::vector<std::string>>(), "<set>:<binding>=<set>:<binding>");
+    addOpt("remap-location", "Move stage input/output location", cxxopts::value<std::vector<std::string>>(), "in|out:<loc>=<loc>");
+    addOpt("B,batch", "Compile each input separately into the -O directory, inputs need distinct file names");
+    addOpt("j,jobs", "Batch jobs, 0 for one per core", cxxopts::value<std::string>()->default_value("0"), "<n>");
+    addOpt("memory-budget", "Batch peak memory limit, 0 for none", cxxopts::value<std::string>()->default_value("0"), "<MiB>");
+    addOpt("memory-per-byte", "Batch job memory per byte of preprocessed source or SPIR-V input, see the stress_tests MemoryPerByte report",
+        cxxopts::value<std::string>()->default_value("128"), "<n>");
+    addOpt("low-memory", "Release each stage as soon as the next one is produced");
     addOpt("h,help", "Display available options");
 }
 
@@ -38,23 +61,28 @@ int showHelp(const char* reason = nullptr) {
     return 0;
 }
 
+// Batch jobs print from several threads
+static std::mutex printMutex;
+
 int printError(const char* err) {
+    std::lock_guard<std::mutex> lock(printMutex);
     std::cerr << err << std::endl;
     return 1;
 }
 
 int printError(const std::string& err) {
-    std::cerr << err << std::endl;
-    return 1;
+    return printError(err.c_str());
 }
 
 int printOpenFileError(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(printMutex);
     std::cerr << "Can't open file '" << filename << "'" << std::endl;
     return 1;
 }
 
 void printLog(const std::string& log) {
     if (!log.empty()) {
+        std::lock_guard<std::mutex> lock(printMutex);
         std::cout << log << std::endl;
     }
 }
@@ -166,140 +194,240 @@ void writeSPIRV(std::ostream* os, const std::uint32_t* spirv, std::size_t size)
     os->write(reinterpret_cast<const char*>(spirv), size*4);
 }
 
-void writeSPIRVString(std::ostream* os, const std::string& str) {
-    writeSPIRV(os, reinterpret_cast<const std::uint32_t*>(str.data()), str.size()/4);
-}
-
 void writeString(std::ostream* os, const std::string& str) {
     os->write(str.data(), str.size());
 }
 
-int main(int argc, char** argv) {
-    initOptions();
+bool parseShiftBindings(shader_cross::HLSLAST::Options* opts, const std::vector<std::string>& shifts) {
+    for (auto& shift : shifts) {
+        if (shift.size() < 3 || shift[1] != '=') {
+            return false;
+        }
+        auto base = (unsigned int)std::atoi(shift.c_str() + 2);
+        switch (shift[0]) {
+        case 's':
+            opts->ShiftSamplerBinding = base;
+            break;
+        case 't':
+            opts->ShiftTextureBinding = base;
+            break;
+        case 'b':
+            opts->ShiftConstantBufferBinding = base;
+            break;
+        case 'u':
+            opts->ShiftUAVBinding = base;
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+bool parseRemaps(shader_cross::RemapOptions* opts, const std::vector<std::string>& bindings, const std::vector<std::string>& locations) {
+    for (auto& binding : bindings) {
+        shader_cross::DescriptorRemap remap;
+        unsigned int set, bind, newSet, newBind;
+        if (std::sscanf(binding.c_str(), "%u:%u=%u:%u", &set, &bind, &newSet, &newBind) != 4) {
+            return false;
+        }
+        remap.Set = set;
+        remap.Binding = bind;
+        remap.NewSet = newSet;
+        remap.NewBinding = newBind;
+        opts->Descriptors.push_back(remap);
+    }
+    for (auto& location : locations) {
+        shader_cross::LocationRemap remap;
+        auto pos = location.find(':');
+        if (pos == std::string::npos) {
+            return false;
+        }
+        auto io = location.substr(0, pos);
+        if (io != "in" && io != "out") {
+            return false;
+        }
+        remap.Output = io == "out";
+        unsigned int loc, newLoc;
+        if (std::sscanf(location.c_str() + pos + 1, "%u=%u", &loc, &newLoc) != 2) {
+            return false;
+        }
+        remap.Location = loc;
+        remap.NewLocation = newLoc;
+        opts->Locations.push_back(remap);
+    }
+    return true;
+}
+
+template <class AST>
+int preprocessTo(std::ostream* os, const std::vector<std::string>& sources, const typename AST::Options& opts) {
+    std::string preprocessed;
+    std::string log;
+    if (!AST::Preprocess(sources, opts, &preprocessed, &log)) {
+        return printError(log);
+    }
+    printLog(log);
+    writeString(os, preprocessed);
+    return 0;
+}
+
+template <class AST>
+int parseToSPIRV(AST* ast, const std::vector<std::string>& sources, const typename AST::Options& opts, const shader_cross::SPIRVOptions& spirvOpts, bool release, std::vector<std::uint32_t>* spirv) {
+    {
+        std::string log;
+        if (!ast->Parse(sources, opts, &log)) {
+            return printError(log);
+        }
+        printLog(log);
+    }
+    std::string log;
+    if (!ast->ToSPIRV(spirv, spirvOpts, &log)) {
+        return printError(log);
+    }
+    printLog(log);
+    if (release) {
+        ast->Release();
+    }
+    return 0;
+}
 
+struct CompileConfig {
     std::string stageStr;
-    std::vector<std::string> inputs;
-    std::string output;
     std::string from;
     std::string target;
-    int version;
+    int version = 0;
     std::vector<std::string> includes;
+    std::vector<std::string> defines;
+    bool preprocessOnly = false;
+    // Inputs are preprocessOnly output
+    bool preprocessed = false;
+    std::string entryPoint;
+    int shaderModel = 0;
+    shader_cross::HLSLAST::Options shifts;
+    bool autoMapBindings = false;
+    shader_cross::RemapOptions remap;
+    bool lowMemory = false;
+};
 
-    try {
-        auto opts = options.parse(argc, argv);
-        if (opts.count("help")) {
-            return showHelp();
-        }
-        if (opts.count("inputs")) {
-            inputs = opts["inputs"].as<std::vector<std::string>>();
-        }
-        stageStr = opts["stage"].as<std::string>();
-        output = opts["output"].as<std::string>();
-        from = opts["from"].as<std::string>();
-        target = opts["target"].as<std::string>();
-        version = toVersion(opts["version"].as<std::string>());
-        if (opts.count("include")) {
-            includes = opts["include"].as<std::vector<std::string>>();
-        }
-    } catch (const cxxopts::missing_argument_exception& e) {
-        return printError(e.what());
-    } catch (const cxxopts::option_not_exists_exception& e) {
-        return printError(e.what());
-    }
+// names is empty for stdin input
+int compile(const CompileConfig& cfg, const std::vector<std::string>& names, std::vector<std::string> inputContents, std::ostream* outputStream) {
+    const std::string& stageStr = cfg.stageStr;
+    const std::string& from = cfg.from;
+    const std::string& target = cfg.target;
+    int version = cfg.version;
+    const std::vector<std::string>& includes = cfg.includes;
+    const std::vector<std::string>& defines = cfg.defines;
+    bool preprocessOnly = cfg.preprocessOnly;
+    const std::string& entryPoint = cfg.entryPoint;
+    int shaderModel = cfg.shaderModel;
+    bool autoMapBindings = cfg.autoMapBindings;
+    const shader_cross::RemapOptions& remap = cfg.remap;
 
     shader_cross::Stage stage = shader_cross::Stage::None;
-    if (from == "glsl") {
-        stage = toStage(stageStr, inputs);
+    if (from == "glsl" || from == "hlsl") {
+        stage = toStage(stageStr, names);
         if (stage == shader_cross::Stage::None) {
             if (!stageStr.empty()) {
-                std::cerr << "Unknown stage '" << stageStr << "'" << std::endl;
-                return 1;
+                return printError("Unknown stage '" + stageStr + "'");
             }
             return printError("Unknown stage");
         }
     }
-    
-    bool inputFromStdin = false;
-    std::vector<std::string> inputContents;
-    if (inputs.empty() || inputs[0] == "-") {
-        inputContents.emplace_back(readToString(std::cin));
-        inputFromStdin = true;
-    } else {
-        auto pos = readToStrings(&inputContents, inputs);
-        if (pos != inputs.size()) {
-            return printOpenFileError(inputs[pos]);
-        }
-    }
-
-    std::ostream* outputStream;
-    std::ofstream ofs;
-    if (output == "-") {
-        outputStream = &std::cout;
-    } else {
-        ofs.open(output);
-        if (!ofs) {
-            return printOpenFileError(output);
-        }
-        outputStream = &ofs;
-    }
 
     shader_cross::GLSLAST glslAST;
+    shader_cross::HLSLAST hlslAST;
     shader_cross::SPIRVIR spirvIR;
+    shader_cross::SPIRVIR::Options irOpts;
+    irOpts.RetainIR = !cfg.lowMemory;
 
-    if (from == "glsl") {
-        {
+    if (from == "glsl" || from == "hlsl") {
+        std::vector<std::uint32_t> spirv;
+        shader_cross::SPIRVOptions spirvOpts;
+        if (target == "spirv") {
+            if (version > 0) {
+                spirvOpts.Version = version;
+            }
+            spirvOpts.Remap = remap;
+        }
+        int ret;
+        if (from == "glsl") {
             shader_cross::GLSLAST::Options opts;
             opts.Stage = stage;
-            if (!inputFromStdin) {
-                opts.Names = inputs;
-            }
+            opts.EntryPoint = entryPoint;
+            opts.Names = names;
             opts.IncludeDirectories = includes;
-            std::string log;
-            if (!glslAST.Parse(inputContents, opts, &log)) {
-                return printError(log);
+            opts.Defines = defines;
+            opts.Preprocessed = cfg.preprocessed;
+            if (preprocessOnly) {
+                return preprocessTo<shader_cross::GLSLAST>(outputStream, inputContents, opts);
             }
-            printLog(log);
-        }
-        std::vector<std::uint32_t> spirv;
-        {
-            shader_cross::SPIRVOptions opts;
-            if (target == "spirv" && version > 0) {
-                opts.Version = version;
+            ret = parseToSPIRV(&glslAST, inputContents, opts, spirvOpts, cfg.lowMemory, &spirv);
+        } else {
+            shader_cross::HLSLAST::Options opts;
+            opts.Stage = stage;
+            opts.EntryPoint = entryPoint;
+            if (shaderModel > 0) {
+                opts.ShaderModel = shaderModel;
             }
-            std::string log;
-            if (!glslAST.ToSPIRV(&spirv, opts, &log)) {
-                return printError(log);
+            opts.Names = names;
+            opts.IncludeDirectories = includes;
+            opts.Defines = defines;
+            opts.Preprocessed = cfg.preprocessed;
+            opts.AutoMapBindings = autoMapBindings;
+            opts.ShiftSamplerBinding = cfg.shifts.ShiftSamplerBinding;
+            opts.ShiftTextureBinding = cfg.shifts.ShiftTextureBinding;
+            opts.ShiftConstantBufferBinding = cfg.shifts.ShiftConstantBufferBinding;
+            opts.ShiftUAVBinding = cfg.shifts.ShiftUAVBinding;
+            if (preprocessOnly) {
+                return preprocessTo<shader_cross::HLSLAST>(outputStream, inputContents, opts);
             }
-            printLog(log);
+            ret = parseToSPIRV(&hlslAST, inputContents, opts, spirvOpts, cfg.lowMemory, &spirv);
+        }
+        if (ret != 0) {
+            return ret;
+        }
+        if (cfg.lowMemory) {
+            std::vector<std::string>().swap(inputContents);
         }
         if (target == "spirv") {
             writeSPIRV(outputStream, spirv.data(), spirv.size());
             return 0;
         }
         std::string log;
-        if (!spirvIR.Parse(spirv, &log)) {
+        if (!spirvIR.Parse(std::move(spirv), irOpts, &log)) {
             return printError(log);
         }
         printLog(log);
     } else if (from == "spirv") {
-        auto inputContent = joinStrings(inputContents);
+        std::vector<std::uint32_t> spirv;
+        {
+            auto inputContent = joinStrings(inputContents);
+            std::vector<std::string>().swap(inputContents);
+            spirv.resize(inputContent.size()/4);
+            std::memcpy(spirv.data(), inputContent.data(), spirv.size()*4);
+        }
         if (target == "spirv") {
-            writeSPIRVString(outputStream, inputContent);
+            // Patched in place, no recompilation
+            std::string log;
+            if (!shader_cross::RemapSPIRV(&spirv, remap, &log)) {
+                return printError(log);
+            }
+            writeSPIRV(outputStream, spirv.data(), spirv.size());
             return 0;
         }
         std::string log;
-        if (!spirvIR.Parse(reinterpret_cast<const std::uint32_t*>(inputContents.data()), inputContents.size(), &log)) {
+        if (!spirvIR.Parse(std::move(spirv), irOpts, &log)) {
             return printError(log);
         }
         printLog(log);
     } else {
-        std::cerr << "Unsupported from language " << from << std::endl;
-        return 1;
+        return printError("Unsupported from language " + from);
     }
 
     if (target == "glsl") {
         std::string glsl;
         shader_cross::GLSLOptions opts;
+        opts.Remap = remap;
         if (version > 0) {
             opts.Version = version;
         }
@@ -312,6 +440,7 @@ int main(int argc, char** argv) {
     } else if (target == "essl") {
         std::string essl;
         shader_cross::ESSLOptions opts;
+        opts.Remap = remap;
         if (version > 0) {
             opts.Version = version;
         }
@@ -324,6 +453,7 @@ int main(int argc, char** argv) {
     } else if (target == "hlsl") {
         std::string hlsl;
         shader_cross::HLSLOptions opts;
+        opts.Remap = remap;
         if (version > 0) {
             opts.Model = version;
         }
@@ -336,6 +466,7 @@ int main(int argc, char** argv) {
     } else if (target == "msl") {
         std::string msl;
         shader_cross::MSLOptions opts;
+        opts.Remap = remap;
         if (version > 0) {
             opts.Version = version;
         }
@@ -346,10 +477,231 @@ int main(int argc, char** argv) {
         printLog(log);
         writeString(outputStream, msl);
     } else {
-        std::cerr << "Unsupported target language " << target << std::endl;
-        return 1;
+        return printError("Unsupported target language " + target);
     }
 
     return 0;
 }
 
+// Throttles batch jobs so that their estimated memory stays within the budget;
+// a job estimated above the whole budget runs alone.
+class MemoryBudget {
+public:
+    explicit MemoryBudget(std::size_t budget) : budget(budget) {}
+
+    void Acquire(std::size_t size) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [this, size] { return budget == 0 || used == 0 || used + size <= budget; });
+        used += size;
+    }
+
+    void Release(std::size_t size) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            used -= size;
+        }
+        cond.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::size_t budget;
+    std::size_t used = 0;
+};
+
+std::string targetExtension(const CompileConfig& cfg) {
+    if (cfg.preprocessOnly) {
+        return ".i";
+    }
+    if (cfg.target == "spirv") {
+        return ".spv";
+    } else if (cfg.target == "msl") {
+        return ".metal";
+    }
+    return "." + cfg.target;
+}
+
+std::string batchOutputOf(const std::string& input, const std::string& outputDir, const std::string& ext) {
+    if (outputDir == "-") {
+        return input + ext;
+    }
+    auto pos = input.find_last_of("/\\");
+    return outputDir + "/" + (pos == std::string::npos ? input : input.substr(pos + 1)) + ext;
+}
+
+// Inputs from different directories may share a file name, and so an output
+bool batchOutputsOf(std::vector<std::string>* outputs, const std::vector<std::string>& inputs, const std::string& outputDir, const std::string& ext) {
+    std::unordered_map<std::string, std::size_t> inputOf;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        outputs->push_back(batchOutputOf(inputs[i], outputDir, ext));
+        auto inserted = inputOf.emplace(outputs->back(), i);
+        if (!inserted.second) {
+            printError("'" + inputs[inserted.first->second] + "' and '" + inputs[i] + "' would both be written to '" + outputs->back() + "'");
+            return false;
+        }
+    }
+    return true;
+}
+
+// Sources are expanded before the budget is taken, so included files are counted;
+// the expansion of each running job is outside the budget.
+bool batchPreprocess(const CompileConfig& cfg, const std::string& input, std::vector<std::string>* inputContents) {
+    if ((cfg.from != "glsl" && cfg.from != "hlsl") || cfg.preprocessOnly) {
+        return true;
+    }
+    CompileConfig preprocessCfg = cfg;
+    preprocessCfg.preprocessOnly = true;
+    std::ostringstream oss;
+    if (compile(preprocessCfg, { input }, std::move(*inputContents), &oss) != 0) {
+        return false;
+    }
+    inputContents->assign(1, oss.str());
+    return true;
+}
+
+int compileBatch(const CompileConfig& cfg, const std::vector<std::string>& inputs, const std::string& outputDir, unsigned jobs,
+        std::size_t memoryBudget, std::size_t memoryPerByte) {
+    if (jobs == 0) {
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::vector<std::string> outputs;
+    if (!batchOutputsOf(&outputs, inputs, outputDir, targetExtension(cfg))) {
+        return 1;
+    }
+    MemoryBudget budget(memoryBudget);
+    std::atomic<std::size_t> next(0);
+    std::atomic<int> failures(0);
+    CompileConfig compileCfg = cfg;
+    compileCfg.preprocessed = (cfg.from == "glsl" || cfg.from == "hlsl") && !cfg.preprocessOnly;
+    auto worker = [&]() {
+        for (std::size_t i = next++; i < inputs.size(); i = next++) {
+            std::vector<std::string> inputContents;
+            if (readToStrings(&inputContents, { inputs[i] }) != 1) {
+                printOpenFileError(inputs[i]);
+                ++failures;
+                continue;
+            }
+            if (!batchPreprocess(cfg, inputs[i], &inputContents)) {
+                ++failures;
+                continue;
+            }
+            std::size_t estimate = inputContents[0].size() * memoryPerByte;
+            budget.Acquire(estimate);
+            std::ofstream ofs(outputs[i]);
+            int ret = ofs ? compile(compileCfg, { inputs[i] }, std::move(inputContents), &ofs) : printOpenFileError(outputs[i]);
+            budget.Release(estimate);
+            if (ret != 0) {
+                ++failures;
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < jobs && t < inputs.size(); ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return failures > 0 ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    initOptions();
+
+    CompileConfig cfg;
+    std::vector<std::string> inputs;
+    std::string output;
+    std::vector<std::string> shiftBindings;
+    std::vector<std::string> remapBindings;
+    std::vector<std::string> remapLocations;
+    bool batch = false;
+    int jobs = 0;
+    int memoryBudgetMiB = 0;
+    int memoryPerByte = 0;
+
+    try {
+        auto opts = options.parse(argc, argv);
+        if (opts.count("help")) {
+            return showHelp();
+        }
+        if (opts.count("inputs")) {
+            inputs = opts["inputs"].as<std::vector<std::string>>();
+        }
+        cfg.stageStr = opts["stage"].as<std::string>();
+        output = opts["output"].as<std::string>();
+        cfg.from = opts["from"].as<std::string>();
+        cfg.target = opts["target"].as<std::string>();
+        cfg.version = toVersion(opts["version"].as<std::string>());
+        if (opts.count("include")) {
+            cfg.includes = opts["include"].as<std::vector<std::string>>();
+        }
+        if (opts.count("define")) {
+            cfg.defines = opts["define"].as<std::vector<std::string>>();
+        }
+        cfg.preprocessOnly = opts.count("preprocess") > 0;
+        cfg.entryPoint = opts["entry"].as<std::string>();
+        cfg.shaderModel = toVersion(opts["shader-model"].as<std::string>());
+        if (opts.count("shift-binding")) {
+            shiftBindings = opts["shift-binding"].as<std::vector<std::string>>();
+        }
+        cfg.autoMapBindings = opts.count("auto-map-bindings") > 0;
+        if (opts.count("remap-binding")) {
+            remapBindings = opts["remap-binding"].as<std::vector<std::string>>();
+        }
+        if (opts.count("remap-location")) {
+            remapLocations = opts["remap-location"].as<std::vector<std::string>>();
+        }
+        batch = opts.count("batch") > 0;
+        jobs = toVersion(opts["jobs"].as<std::string>());
+        memoryBudgetMiB = toVersion(opts["memory-budget"].as<std::string>());
+        memoryPerByte = toVersion(opts["memory-per-byte"].as<std::string>());
+        cfg.lowMemory = opts.count("low-memory") > 0;
+    } catch (const cxxopts::missing_argument_exception& e) {
+        return printError(e.what());
+    } catch (const cxxopts::option_not_exists_exception& e) {
+        return printError(e.what());
+    }
+
+    if (!parseShiftBindings(&cfg.shifts, shiftBindings)) {
+        return printError("Invalid shift binding, expected <class>=<n> with class s, t, b or u");
+    }
+    if (!parseRemaps(&cfg.remap, remapBindings, remapLocations)) {
+        return printError("Invalid remap, expected <set>:<binding>=<set>:<binding> or in|out:<loc>=<loc>");
+    }
+
+    if (batch) {
+        if (inputs.empty()) {
+            return printError("Batch mode needs input files");
+        }
+        std::size_t memoryBudget = std::size_t(std::max(memoryBudgetMiB, 0)) * 1024 * 1024;
+        return compileBatch(cfg, inputs, output, unsigned(std::max(jobs, 0)), memoryBudget, std::size_t(std::max(memoryPerByte, 1)));
+    }
+
+    bool inputFromStdin = false;
+    std::vector<std::string> inputContents;
+    if (inputs.empty() || inputs[0] == "-") {
+        inputContents.emplace_back(readToString(std::cin));
+        inputFromStdin = true;
+    } else {
+        auto pos = readToStrings(&inputContents, inputs);
+        if (pos != inputs.size()) {
+            return printOpenFileError(inputs[pos]);
+        }
+    }
+
+    std::ostream* outputStream;
+    std::ofstream ofs;
+    if (output == "-") {
+        outputStream = &std::cout;
+    } else {
+        ofs.open(output);
+        if (!ofs) {
+            return printOpenFileError(output);
+        }
+        outputStream = &ofs;
+    }
+
+    return compile(cfg, inputFromStdin ? std::vector<std::string>() : inputs, std::move(inputContents), outputStream);
+}
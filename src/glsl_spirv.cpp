@@ -1,9 +1,6 @@
-#include <shader_cross/shader_cross.hpp>
+#include "glslang.hpp"
 
-#include <glslang/Public/ShaderLang.h>
 #include <SPIRV/GlslangToSpv.h>
-#include <StandAlone/ResourceLimits.h>
-#include <StandAlone/DirStackFileIncluder.h>
 
 #include <algorithm>
 
@@ -20,33 +17,13 @@ struct GlslangInitializer {
 
 static GlslangInitializer glslangInitializer;
 
-static inline EShLanguage stageToEShLang(Stage stage) {
-    switch (stage) {
-    case Stage::None:
-        return EShLangCount;
-    case Stage::Vertex:
-        return EShLangVertex;
-    case Stage::TessControl:
-        return EShLangTessControl;
-    case Stage::TessEvaluation:
-        return EShLangTessEvaluation;
-    case Stage::Fragment:
-        return EShLangFragment;
-    case Stage::Geometry:
-        return EShLangGeometry;
-    case Stage::Compute:
-        return EShLangCompute;
-    }
-    return EShLangCount;
-}
-
 void GLSLAST::TShaderDeleter::operator()(glslang::TShader* shader) {
     delete shader;
 }
 
 std::vector<const char*> toGlslangStrings(const std::string* strings, std::size_t size) {
-    std::vector<const char*> cStrings(strings->size());
-    for (std::size_t i = 0; i < strings->size(); ++i) {
+    std::vector<const char*> cStrings(size);
+    for (std::size_t i = 0; i < size; ++i) {
         cStrings[i] = strings[i].c_str();
     }
     return cStrings;
@@ -60,46 +37,154 @@ std::string defaultFilenameOf(int index) {
     return name;
 }
 
-bool GLSLAST::Parse(const char** glsls, const std::size_t* sizes, int num, const Options& opts, std::string* log) {
-    const TBuiltInResource* resources = &glslang::DefaultTBuiltInResource;
-    EShMessages messages = EShMsgDefault;
-    shader.reset(new glslang::TShader(stageToEShLang(opts.Stage)));
-    // Sources
-    std::vector<int> lens(num);
+std::string definesPreamble(const std::vector<std::string>& defines) {
+    std::string preamble;
+    for (auto& define : defines) {
+        preamble.append("#define ");
+        auto pos = define.find('=');
+        if (pos == std::string::npos) {
+            preamble.append(define);
+        } else {
+            preamble.append(define, 0, pos);
+            preamble.append(" ");
+            preamble.append(define, pos + 1, std::string::npos);
+        }
+        preamble.append("\n");
+    }
+    return preamble;
+}
+
+ShaderSources::ShaderSources(glslang::TShader* shader, const char** sources, const std::size_t* sizes, int num,
+        const std::vector<std::string>& names, const std::string& entryPoint, const std::string& preamble)
+    : lens(num), names(names), preamble(preamble) {
     for (int i = 0; i < num; ++i) {
         lens[i] = int(sizes[i]);
     }
-    std::vector<std::string> names = opts.Names;
-    names.resize(num);
-    for (int i = int(opts.Names.size()); i < num; ++i) {
-        names[i] = defaultFilenameOf(i);
+    this->names.resize(num);
+    for (int i = int(names.size()); i < num; ++i) {
+        this->names[i] = defaultFilenameOf(i);
     }
-    std::vector<const char*> cNames = toGlslangStrings(names.data(), names.size());
-    shader->setStringsWithLengthsAndNames(glsls, lens.data(), cNames.data(), num);
-    // EntryPoint
-    if (!opts.EntryPoint.empty()) {
-        shader->setEntryPoint(opts.EntryPoint.c_str());
+    cNames = toGlslangStrings(this->names.data(), this->names.size());
+    shader->setStringsWithLengthsAndNames(sources, lens.data(), cNames.data(), num);
+    if (!this->preamble.empty()) {
+        shader->setPreamble(this->preamble.c_str());
     }
-    bool parsed = false;
-    // Include & Parse
-    if (opts.EnableInclude) {
-        shader->setPreamble("#extension GL_GOOGLE_include_directive : enable\n");
-        DirStackFileIncluder includer;
-        for (auto& dir : opts.IncludeDirectories) {
-            includer.pushExternalLocalDirectory(dir);
-        }
-        parsed = shader->parse(resources, opts.DefaultVersion, false, messages, includer);
-    } else {
-        parsed = shader->parse(resources, opts.DefaultVersion, false, messages);
+    // EntryPoint
+    if (!entryPoint.empty()) {
+        shader->setEntryPoint(entryPoint.c_str());
     }
+}
+
+void appendShaderLog(glslang::TShader* shader, std::string* log) {
     if (log) {
         log->append(shader->getInfoLog());
         log->append(shader->getInfoDebugLog());
     }
+}
+
+static std::string preambleOf(const GLSLAST::Options& opts) {
+    std::string preamble;
+    if (opts.Preprocessed) {
+        // For the #line directives naming included files
+        preamble.append("#extension GL_GOOGLE_cpp_style_line_directive : enable\n");
+        return preamble;
+    }
+    if (opts.EnableInclude) {
+        preamble.append("#extension GL_GOOGLE_include_directive : enable\n");
+    }
+    preamble.append(definesPreamble(opts.Defines));
+    return preamble;
+}
+
+// Preprocess echoes the preamble's #extension lines ahead of #version, which must come first.
+// Returns the size of the lines to blank out, 0 if there is no #version after them.
+static std::size_t echoedPreambleSize(const char* glsl, std::size_t size) {
+    const char* end = glsl + size;
+    const char* line = glsl;
+    while (line != end) {
+        const char* next = std::find(line, end, '\n');
+        const char* text = line;
+        while (text != next && (*text == ' ' || *text == '\t' || *text == '\r')) {
+            ++text;
+        }
+        std::string directive(text, std::min<std::size_t>(next - text, 10));
+        if (directive.compare(0, 8, "#version") == 0) {
+            return std::size_t(line - glsl);
+        }
+        if (text != next && directive.compare(0, 10, "#extension") != 0 && directive.compare(0, 5, "#line") != 0) {
+            return 0;
+        }
+        line = next == end ? end : next + 1;
+    }
+    return 0;
+}
+
+bool GLSLAST::Preprocess(const char** glsls, const std::size_t* sizes, int num, const Options& opts, std::string* output, std::string* log) {
+    if (opts.PreprocessCache) {
+        return opts.PreprocessCache->Preprocess(glsls, sizes, num, opts, output, log);
+    }
+    const TBuiltInResource* resources = &glslang::DefaultTBuiltInResource;
+    EShMessages messages = EShMsgDefault;
+    glslang::TShader shader(stageToEShLang(opts.Stage));
+    ShaderSources sources(&shader, glsls, sizes, num, opts.Names, opts.EntryPoint, preambleOf(opts));
+    bool preprocessed = withIncluder(opts.EnableInclude && !opts.Preprocessed, opts.IncludeDirectories, [&](glslang::TShader::Includer& includer) {
+        return shader.preprocess(resources, opts.DefaultVersion, ENoProfile, false, false, messages, output, includer);
+    });
+    appendShaderLog(&shader, log);
+    return preprocessed;
+}
+
+bool GLSLAST::Preprocess(const std::string* glsls, int num, const Options& opts, std::string* output, std::string* log) {
+    std::vector<const char*> cGlsls = toGlslangStrings(glsls, num);
+    std::vector<std::size_t> sizes(num);
+    for (int i = 0; i < num; ++i) {
+        sizes[i] = glsls[i].size();
+    }
+    return Preprocess(cGlsls.data(), sizes.data(), num, opts, output, log);
+}
+
+bool GLSLAST::Preprocess(const std::vector<std::string>& glsls, const Options& opts, std::string* output, std::string* log) {
+    return Preprocess(glsls.data(), int(glsls.size()), opts, output, log);
+}
+
+bool GLSLAST::Parse(const char** glsls, const std::size_t* sizes, int num, const Options& opts, std::string* log) {
+    if (opts.PreprocessCache) {
+        std::string preprocessed;
+        if (!opts.PreprocessCache->Preprocess(glsls, sizes, num, opts, &preprocessed, log)) {
+            shader.reset();
+            return false;
+        }
+        const char* source = preprocessed.c_str();
+        std::size_t size = preprocessed.size();
+        return this->Parse(&source, &size, 1, preprocessedOptionsOf(opts), log);
+    }
+    std::string first;
+    std::vector<const char*> strings(glsls, glsls + num);
+    if (opts.Preprocessed && num > 0) {
+        std::size_t echoed = echoedPreambleSize(glsls[0], sizes[0]);
+        if (echoed > 0) {
+            // Blanked rather than skipped to keep the line numbers
+            first.assign(glsls[0], sizes[0]);
+            std::replace_if(first.begin(), first.begin() + echoed, [](char c) { return c != '\n'; }, ' ');
+            strings[0] = first.c_str();
+        }
+    }
+    const TBuiltInResource* resources = &glslang::DefaultTBuiltInResource;
+    EShMessages messages = EShMsgDefault;
+    shader.reset(new glslang::TShader(stageToEShLang(opts.Stage)));
+    ShaderSources sources(shader.get(), strings.data(), sizes, num, opts.Names, opts.EntryPoint, preambleOf(opts));
+    // Include & Parse
+    bool parsed = withIncluder(opts.EnableInclude && !opts.Preprocessed, opts.IncludeDirectories, [&](glslang::TShader::Includer& includer) {
+        return shader->parse(resources, opts.DefaultVersion, false, messages, includer);
+    });
+    appendShaderLog(shader.get(), log);
     //glslang::TProgram program;
     //program.addShader(shader.get());
     //program.link(messages);
     //program.mapIO();
+    if (!parsed) {
+        shader.reset();
+    }
     return parsed;
 }
 
@@ -120,8 +205,7 @@ unsigned int toSpvVersion(int version) {
     return (unsigned int)((version/10) << 16) | ((version % 10) << 8);
 }
 
-bool GLSLAST::ToSPIRV(std::vector<std::uint32_t>* spirv, const SPIRVOptions& opts, std::string* log) const {
-    glslang::TIntermediate* intermediate = shader->getIntermediate();
+bool intermediateToSPIRV(glslang::TIntermediate* intermediate, std::vector<std::uint32_t>* spirv, const SPIRVOptions& opts, std::string* log) {
     glslang::SpvVersion spvVersion = intermediate->getSpv();
     spvVersion.spv = toSpvVersion(opts.Version);
     intermediate->setSpv(spvVersion);
@@ -129,6 +213,7 @@ bool GLSLAST::ToSPIRV(std::vector<std::uint32_t>* spirv, const SPIRVOptions& opt
     spv::SpvBuildLogger logger;
     glslang::SpvOptions spvOptions;
     spvOptions.generateDebugInfo = true;
+    // Runs the spirv-opt legalization passes on HLSL
     spvOptions.disableOptimizer = false;
     spvOptions.optimizeSize = false;
     spvOptions.disassemble = false;
@@ -137,7 +222,21 @@ bool GLSLAST::ToSPIRV(std::vector<std::uint32_t>* spirv, const SPIRVOptions& opt
     if (log) {
         log->append(logger.getAllMessages());
     }
-    return true;
+    return RemapSPIRV(spirv, opts.Remap, log);
+}
+
+bool GLSLAST::ToSPIRV(std::vector<std::uint32_t>* spirv, const SPIRVOptions& opts, std::string* log) const {
+    if (!shader) {
+        if (log) {
+            log->append("No parsed shader to convert to SPIR-V");
+        }
+        return false;
+    }
+    return intermediateToSPIRV(shader->getIntermediate(), spirv, opts, log);
+}
+
+void GLSLAST::Release() {
+    shader.reset();
 }
 
 } // namespace shader_cross
@@ -0,0 +1,83 @@
+#ifndef SHADER_CROSS_GLSLANG_H
+#define SHADER_CROSS_GLSLANG_H
+
+#include <shader_cross/shader_cross.hpp>
+
+#include <glslang/Public/ShaderLang.h>
+#include <StandAlone/ResourceLimits.h>
+#include <StandAlone/DirStackFileIncluder.h>
+
+namespace shader_cross {
+
+inline EShLanguage stageToEShLang(Stage stage) {
+    switch (stage) {
+    case Stage::None:
+        return EShLangCount;
+    case Stage::Vertex:
+        return EShLangVertex;
+    case Stage::TessControl:
+        return EShLangTessControl;
+    case Stage::TessEvaluation:
+        return EShLangTessEvaluation;
+    case Stage::Fragment:
+        return EShLangFragment;
+    case Stage::Geometry:
+        return EShLangGeometry;
+    case Stage::Compute:
+        return EShLangCompute;
+    }
+    return EShLangCount;
+}
+
+std::vector<const char*> toGlslangStrings(const std::string* strings, std::size_t size);
+
+std::string defaultFilenameOf(int index);
+
+// "#define" lines for "NAME" / "NAME=VALUE" entries
+std::string definesPreamble(const std::vector<std::string>& defines);
+
+// glslang keeps pointers to the strings, so they must outlive parse/preprocess.
+struct ShaderSources {
+    std::vector<int> lens;
+    std::vector<std::string> names;
+    std::vector<const char*> cNames;
+    std::string preamble;
+
+    ShaderSources(glslang::TShader* shader, const char** sources, const std::size_t* sizes, int num,
+        const std::vector<std::string>& names, const std::string& entryPoint, const std::string& preamble);
+};
+
+template <class Fn>
+bool withIncluder(bool enableInclude, const std::vector<std::string>& includeDirectories, Fn fn) {
+    if (enableInclude) {
+        DirStackFileIncluder includer;
+        for (auto& dir : includeDirectories) {
+            includer.pushExternalLocalDirectory(dir);
+        }
+        return fn(includer);
+    }
+    glslang::TShader::ForbidIncluder includer;
+    return fn(includer);
+}
+
+// Options to parse the Preprocess output of opts' sources
+template <class Options>
+Options preprocessedOptionsOf(const Options& opts) {
+    Options preprocessedOpts = opts;
+    preprocessedOpts.Preprocessed = true;
+    preprocessedOpts.PreprocessCache = nullptr;
+    preprocessedOpts.Defines.clear();
+    preprocessedOpts.Names.resize(1);
+    if (preprocessedOpts.Names[0].empty()) {
+        preprocessedOpts.Names[0] = defaultFilenameOf(0);
+    }
+    return preprocessedOpts;
+}
+
+void appendShaderLog(glslang::TShader* shader, std::string* log);
+
+bool intermediateToSPIRV(glslang::TIntermediate* intermediate, std::vector<std::uint32_t>* spirv, const SPIRVOptions& opts, std::string* log);
+
+} // namespace shader_cross
+
+#endif // SHADER_CROSS_GLSLANG_H
@@ -0,0 +1,143 @@
+#include "glslang.hpp"
+
+namespace shader_cross {
+
+void HLSLAST::TShaderDeleter::operator()(glslang::TShader* shader) {
+    delete shader;
+}
+
+void HLSLAST::TProgramDeleter::operator()(glslang::TProgram* program) {
+    delete program;
+}
+
+static const int hlslDefaultVersion = 100;
+
+static const EShMessages hlslMessages = EShMessages(EShMsgSpvRules | EShMsgVulkanRules | EShMsgReadHlsl);
+
+static std::string preambleOf(const HLSLAST::Options& opts) {
+    std::string preamble;
+    if (opts.Preprocessed) {
+        return preamble;
+    }
+    preamble.append("#define __SHADER_TARGET_MAJOR ");
+    preamble.append(std::to_string(opts.ShaderModel/10));
+    preamble.append("\n#define __SHADER_TARGET_MINOR ");
+    preamble.append(std::to_string(opts.ShaderModel%10));
+    preamble.append("\n");
+    preamble.append(definesPreamble(opts.Defines));
+    return preamble;
+}
+
+static void setupHLSLShader(glslang::TShader* shader, const HLSLAST::Options& opts) {
+    EShLanguage lang = stageToEShLang(opts.Stage);
+    shader->setEnvInput(glslang::EShSourceHlsl, lang, glslang::EShClientVulkan, hlslDefaultVersion);
+    shader->setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    shader->setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    // Register mapping
+    shader->setHlslIoMapping(opts.HlslIoMapping);
+    shader->setAutoMapBindings(opts.AutoMapBindings);
+    shader->setShiftBinding(glslang::EResSampler, opts.ShiftSamplerBinding);
+    shader->setShiftBinding(glslang::EResTexture, opts.ShiftTextureBinding);
+    shader->setShiftBinding(glslang::EResUbo, opts.ShiftConstantBufferBinding);
+    shader->setShiftBinding(glslang::EResUav, opts.ShiftUAVBinding);
+}
+
+bool HLSLAST::Preprocess(const char** hlsls, const std::size_t* sizes, int num, const Options& opts, std::string* output, std::string* log) {
+    if (opts.PreprocessCache) {
+        return opts.PreprocessCache->Preprocess(hlsls, sizes, num, opts, output, log);
+    }
+    const TBuiltInResource* resources = &glslang::DefaultTBuiltInResource;
+    glslang::TShader shader(stageToEShLang(opts.Stage));
+    ShaderSources sources(&shader, hlsls, sizes, num, opts.Names, opts.EntryPoint, preambleOf(opts));
+    setupHLSLShader(&shader, opts);
+    bool preprocessed = withIncluder(opts.EnableInclude && !opts.Preprocessed, opts.IncludeDirectories, [&](glslang::TShader::Includer& includer) {
+        return shader.preprocess(resources, hlslDefaultVersion, ENoProfile, false, false, hlslMessages, output, includer);
+    });
+    appendShaderLog(&shader, log);
+    return preprocessed;
+}
+
+bool HLSLAST::Preprocess(const std::string* hlsls, int num, const Options& opts, std::string* output, std::string* log) {
+    std::vector<const char*> cHlsls = toGlslangStrings(hlsls, num);
+    std::vector<std::size_t> sizes(num);
+    for (int i = 0; i < num; ++i) {
+        sizes[i] = hlsls[i].size();
+    }
+    return Preprocess(cHlsls.data(), sizes.data(), num, opts, output, log);
+}
+
+bool HLSLAST::Preprocess(const std::vector<std::string>& hlsls, const Options& opts, std::string* output, std::string* log) {
+    return Preprocess(hlsls.data(), int(hlsls.size()), opts, output, log);
+}
+
+bool HLSLAST::Parse(const char** hlsls, const std::size_t* sizes, int num, const Options& opts, std::string* log) {
+    if (opts.PreprocessCache) {
+        std::string preprocessed;
+        if (!opts.PreprocessCache->Preprocess(hlsls, sizes, num, opts, &preprocessed, log)) {
+            program.reset();
+            shader.reset();
+            return false;
+        }
+        const char* source = preprocessed.c_str();
+        std::size_t size = preprocessed.size();
+        return this->Parse(&source, &size, 1, preprocessedOptionsOf(opts), log);
+    }
+    const TBuiltInResource* resources = &glslang::DefaultTBuiltInResource;
+    stage = opts.Stage;
+    program.reset();
+    shader.reset(new glslang::TShader(stageToEShLang(opts.Stage)));
+    ShaderSources sources(shader.get(), hlsls, sizes, num, opts.Names, opts.EntryPoint, preambleOf(opts));
+    setupHLSLShader(shader.get(), opts);
+    // Include & Parse
+    bool parsed = withIncluder(opts.EnableInclude && !opts.Preprocessed, opts.IncludeDirectories, [&](glslang::TShader::Includer& includer) {
+        return shader->parse(resources, hlslDefaultVersion, false, hlslMessages, includer);
+    });
+    appendShaderLog(shader.get(), log);
+    if (!parsed) {
+        shader.reset();
+        return false;
+    }
+    // Bindings are shifted and mapped by the linker
+    program.reset(new glslang::TProgram);
+    program->addShader(shader.get());
+    bool linked = program->link(hlslMessages) && program->mapIO();
+    if (log) {
+        log->append(program->getInfoLog());
+        log->append(program->getInfoDebugLog());
+    }
+    if (!linked) {
+        program.reset();
+        shader.reset();
+    }
+    return linked;
+}
+
+bool HLSLAST::Parse(const std::string* hlsls, int num, const Options& opts, std::string* log) {
+    std::vector<const char*> cHlsls = toGlslangStrings(hlsls, num);
+    std::vector<std::size_t> sizes(num);
+    for (int i = 0; i < num; ++i) {
+        sizes[i] = hlsls[i].size();
+    }
+    return this->Parse(cHlsls.data(), sizes.data(), num, opts, log);
+}
+
+bool HLSLAST::Parse(const std::vector<std::string>& hlsls, const Options& opts, std::string* log) {
+    return this->Parse(hlsls.data(), int(hlsls.size()), opts, log);
+}
+
+bool HLSLAST::ToSPIRV(std::vector<std::uint32_t>* spirv, const SPIRVOptions& opts, std::string* log) const {
+    if (!program) {
+        if (log) {
+            log->append("No linked program to convert to SPIR-V");
+        }
+        return false;
+    }
+    return intermediateToSPIRV(program->getIntermediate(stageToEShLang(stage)), spirv, opts, log);
+}
+
+void HLSLAST::Release() {
+    program.reset();
+    shader.reset();
+}
+
+} // namespace shader_cross
@@ -0,0 +1,175 @@
+#include <shader_cross/shader_cross.hpp>
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace shader_cross {
+
+struct PreprocessCache::Impl {
+    struct Entry {
+        std::mutex mutex;
+        bool done = false;
+        std::string output;
+        // Guarded by Impl::mutex
+        bool inLRU = false;
+        std::list<const std::string*>::iterator lru;
+    };
+
+    std::size_t maxBytes = 0;
+    std::size_t bytes = 0;
+    mutable std::mutex mutex;
+    // Keys of finished entries, most recently used first
+    std::list<const std::string*> lru;
+    std::unordered_map<std::string, std::shared_ptr<Entry>> entries;
+
+    void Erase(std::unordered_map<std::string, std::shared_ptr<Entry>>::iterator it) {
+        if (it->second->inLRU) {
+            bytes -= it->first.size() + it->second->output.size();
+            lru.erase(it->second->lru);
+        }
+        entries.erase(it);
+    }
+
+    template <class PreprocessFn>
+    bool Get(const std::string& key, PreprocessFn preprocess, std::string* output) {
+        std::shared_ptr<Entry> entry;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto& slot = entries[key];
+            if (!slot) {
+                slot = std::make_shared<Entry>();
+            } else if (slot->inLRU) {
+                lru.splice(lru.begin(), lru, slot->lru);
+            }
+            entry = slot;
+        }
+        // Concurrent requests for the same key wait for the first one instead of preprocessing again.
+        std::lock_guard<std::mutex> entryLock(entry->mutex);
+        if (!entry->done) {
+            bool preprocessed = preprocess(&entry->output);
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = entries.find(key);
+            if (!preprocessed) {
+                entry->output.clear();
+                if (it != entries.end() && it->second == entry) {
+                    entries.erase(it);
+                }
+                return false;
+            }
+            entry->done = true;
+            if (it != entries.end() && it->second == entry) {
+                lru.push_front(&it->first);
+                entry->lru = lru.begin();
+                entry->inLRU = true;
+                bytes += key.size() + entry->output.size();
+                while (maxBytes != 0 && bytes > maxBytes && lru.size() > 1) {
+                    Erase(entries.find(*lru.back()));
+                }
+            }
+        }
+        *output = entry->output;
+        return true;
+    }
+};
+
+void PreprocessCache::ImplDeleter::operator()(Impl* impl) {
+    delete impl;
+}
+
+static void appendKey(std::string* key, const char* data, std::size_t size) {
+    key->append(std::to_string(size));
+    key->append(":");
+    key->append(data, size);
+}
+
+static void appendKey(std::string* key, const std::string& s) {
+    appendKey(key, s.data(), s.size());
+}
+
+static void appendKey(std::string* key, const std::vector<std::string>& strings) {
+    key->append(std::to_string(strings.size()));
+    key->append("#");
+    for (auto& s : strings) {
+        appendKey(key, s);
+    }
+}
+
+template <class Options>
+static std::string keyOf(const char* lang, int version, const char** sources, const std::size_t* sizes, int num, const Options& opts) {
+    std::string key(lang);
+    key.append(",");
+    key.append(std::to_string(int(opts.Stage)));
+    key.append(",");
+    key.append(std::to_string(version));
+    key.append(opts.EnableInclude ? ",i" : ",-");
+    appendKey(&key, opts.Names);
+    appendKey(&key, opts.IncludeDirectories);
+    appendKey(&key, opts.Defines);
+    key.append(std::to_string(num));
+    key.append("#");
+    for (int i = 0; i < num; ++i) {
+        appendKey(&key, sources[i], sizes[i]);
+    }
+    return key;
+}
+
+template <class Options>
+static bool preprocessStrings(PreprocessCache* cache, const std::vector<std::string>& sources, const Options& opts, std::string* output, std::string* log) {
+    std::vector<const char*> cSources(sources.size());
+    std::vector<std::size_t> sizes(sources.size());
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        cSources[i] = sources[i].c_str();
+        sizes[i] = sources[i].size();
+    }
+    return cache->Preprocess(cSources.data(), sizes.data(), int(sources.size()), opts, output, log);
+}
+
+PreprocessCache::PreprocessCache(std::size_t maxBytes) : impl(new Impl) {
+    impl->maxBytes = maxBytes;
+}
+
+bool PreprocessCache::Preprocess(const char** glsls, const std::size_t* sizes, int num, const GLSLAST::Options& opts, std::string* output, std::string* log) {
+    auto preprocess = [&](std::string* out) {
+        GLSLAST::Options preprocessOpts = opts;
+        preprocessOpts.PreprocessCache = nullptr;
+        return GLSLAST::Preprocess(glsls, sizes, num, preprocessOpts, out, log);
+    };
+    return impl->Get(keyOf("glsl", opts.DefaultVersion, glsls, sizes, num, opts), preprocess, output);
+}
+
+bool PreprocessCache::Preprocess(const std::vector<std::string>& glsls, const GLSLAST::Options& opts, std::string* output, std::string* log) {
+    return preprocessStrings(this, glsls, opts, output, log);
+}
+
+bool PreprocessCache::Preprocess(const char** hlsls, const std::size_t* sizes, int num, const HLSLAST::Options& opts, std::string* output, std::string* log) {
+    auto preprocess = [&](std::string* out) {
+        HLSLAST::Options preprocessOpts = opts;
+        preprocessOpts.PreprocessCache = nullptr;
+        return HLSLAST::Preprocess(hlsls, sizes, num, preprocessOpts, out, log);
+    };
+    return impl->Get(keyOf("hlsl", opts.ShaderModel, hlsls, sizes, num, opts), preprocess, output);
+}
+
+bool PreprocessCache::Preprocess(const std::vector<std::string>& hlsls, const HLSLAST::Options& opts, std::string* output, std::string* log) {
+    return preprocessStrings(this, hlsls, opts, output, log);
+}
+
+std::size_t PreprocessCache::Size() const {
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    return impl->entries.size();
+}
+
+std::size_t PreprocessCache::Bytes() const {
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    return impl->bytes;
+}
+
+void PreprocessCache::Clear() {
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    impl->lru.clear();
+    impl->entries.clear();
+    impl->bytes = 0;
+}
+
+} // namespace shader_cross
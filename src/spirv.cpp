@@ -6,11 +6,13 @@ void SPIRVIR::ParserDeleter::operator()(spirv_cross::Parser* parser) {
     delete parser;
 }
 
-bool SPIRVIR::Parse(const std::uint32_t* data, std::size_t size, std::string* log) {
+bool SPIRVIR::Parse(std::vector<std::uint32_t>&& spirv, const Options& opts, std::string* log) {
+    this->retainIR = opts.RetainIR;
     try {
-        this->parser.reset(new spirv_cross::Parser(data, size));
+        this->parser.reset(new spirv_cross::Parser(std::move(spirv)));
         this->parser->parse();
     } catch (const spirv_cross::CompilerError& e) {
+        this->parser.reset();
         if (log) {
             log->append(e.what());
         }
@@ -19,8 +21,20 @@ bool SPIRVIR::Parse(const std::uint32_t* data, std::size_t size, std::string* lo
     return true;
 }
 
+bool SPIRVIR::Parse(const std::uint32_t* data, std::size_t size, const Options& opts, std::string* log) {
+    return this->Parse(std::vector<std::uint32_t>(data, data + size), opts, log);
+}
+
+bool SPIRVIR::Parse(const std::uint32_t* data, std::size_t size, std::string* log) {
+    return this->Parse(data, size, Options(), log);
+}
+
 bool SPIRVIR::Parse(const std::vector<std::uint32_t>& spirv, std::string* log) {
     return this->Parse(spirv.data(), spirv.size(), log);
 }
 
+void SPIRVIR::Release() {
+    this->parser.reset();
+}
+
 } // namespace shader_cross
@@ -2,17 +2,90 @@
 #define SHADER_CROSS_SPIRV_H
 
 #include <shader_cross/shader_cross.hpp>
-#include <spirv_common.hpp>
+#include <spirv_cross.hpp>
 #include <spirv_parser.hpp>
 
 namespace shader_cross {
 
+template <class Resources>
+void spirvRemapDescriptors(spirv_cross::Compiler& compiler, const Resources& resources, const std::vector<DescriptorRemap>& remaps) {
+    for (auto& resource : resources) {
+        if (!compiler.has_decoration(resource.id, spv::DecorationBinding)) {
+            continue;
+        }
+        std::uint32_t set = compiler.get_decoration(resource.id, spv::DecorationDescriptorSet);
+        std::uint32_t binding = compiler.get_decoration(resource.id, spv::DecorationBinding);
+        for (auto& remap : remaps) {
+            if (remap.Set == set && remap.Binding == binding) {
+                if (remap.NewSet != set) {
+                    compiler.set_decoration(resource.id, spv::DecorationDescriptorSet, remap.NewSet);
+                }
+                compiler.set_decoration(resource.id, spv::DecorationBinding, remap.NewBinding);
+                break;
+            }
+        }
+    }
+}
+
+template <class Resources>
+void spirvRemapLocations(spirv_cross::Compiler& compiler, const Resources& resources, bool output, const std::vector<LocationRemap>& remaps) {
+    for (auto& resource : resources) {
+        if (!compiler.has_decoration(resource.id, spv::DecorationLocation)) {
+            continue;
+        }
+        std::uint32_t location = compiler.get_decoration(resource.id, spv::DecorationLocation);
+        for (auto& remap : remaps) {
+            if (remap.Output == output && remap.Location == location) {
+                compiler.set_decoration(resource.id, spv::DecorationLocation, remap.NewLocation);
+                break;
+            }
+        }
+    }
+}
+
+inline void spirvRemap(spirv_cross::Compiler& compiler, const RemapOptions& opts) {
+    if (opts.Descriptors.empty() && opts.Locations.empty()) {
+        return;
+    }
+    spirv_cross::ShaderResources resources = compiler.get_shader_resources();
+    spirvRemapDescriptors(compiler, resources.uniform_buffers, opts.Descriptors);
+    spirvRemapDescriptors(compiler, resources.storage_buffers, opts.Descriptors);
+    spirvRemapDescriptors(compiler, resources.storage_images, opts.Descriptors);
+    spirvRemapDescriptors(compiler, resources.sampled_images, opts.Descriptors);
+    spirvRemapDescriptors(compiler, resources.separate_images, opts.Descriptors);
+    spirvRemapDescriptors(compiler, resources.separate_samplers, opts.Descriptors);
+    spirvRemapDescriptors(compiler, resources.subpass_inputs, opts.Descriptors);
+    spirvRemapDescriptors(compiler, resources.atomic_counters, opts.Descriptors);
+    spirvRemapLocations(compiler, resources.stage_inputs, false, opts.Locations);
+    spirvRemapLocations(compiler, resources.stage_outputs, true, opts.Locations);
+}
+
 template <class Compiler, class InitFn>
-bool spirvCompile(InitFn& initFn, const spirv_cross::ParsedIR& spirvIR, std::string* out, std::string* log) {
+void spirvCompile(Compiler& compiler, InitFn& initFn, const RemapOptions& remap, std::string* out) {
+    spirvRemap(compiler, remap);
+    initFn(compiler);
+    *out = compiler.compile();
+}
+
+// Compiles from a copy of the parser's IR, or moves the IR into the compiler and
+// frees the parser when the SPIRVIR doesn't retain its IR.
+template <class Compiler, class InitFn, class ParserPtr>
+bool spirvCompile(InitFn& initFn, ParserPtr& parser, bool retainIR, const RemapOptions& remap, std::string* out, std::string* log) {
+    if (!parser) {
+        if (log) {
+            log->append("No SPIR-V IR to compile: not parsed, released or consumed by a previous To* call");
+        }
+        return false;
+    }
     try {
-        Compiler compiler(spirvIR);
-        initFn(compiler);
-        *out = compiler.compile();
+        if (retainIR) {
+            Compiler compiler(parser->get_parsed_ir());
+            spirvCompile(compiler, initFn, remap, out);
+        } else {
+            Compiler compiler(std::move(parser->get_parsed_ir()));
+            parser.reset();
+            spirvCompile(compiler, initFn, remap, out);
+        }
     } catch (const spirv_cross::CompilerError& e) {
         if (log) {
             log->append(e.what());
@@ -3,23 +3,23 @@
 
 namespace shader_cross {
 
-bool SPIRVIR::ToGLSL(std::string* glsl, const GLSLOptions& opts, std::string* log) const {
+bool SPIRVIR::ToGLSL(std::string* glsl, const GLSLOptions& opts, std::string* log) {
     auto initFn = [&opts](spirv_cross::CompilerGLSL& compiler) {
         spirv_cross::CompilerGLSL::Options glslOpts = compiler.get_common_options();
         glslOpts.version = opts.Version;
         compiler.set_common_options(glslOpts);
     };
-    return spirvCompile<spirv_cross::CompilerGLSL>(initFn, this->parser->get_parsed_ir(), glsl, log);
+    return spirvCompile<spirv_cross::CompilerGLSL>(initFn, this->parser, this->retainIR, opts.Remap, glsl, log);
 }
 
-bool SPIRVIR::ToESSL(std::string* glsl, const ESSLOptions& opts, std::string* log) const {
+bool SPIRVIR::ToESSL(std::string* glsl, const ESSLOptions& opts, std::string* log) {
     auto initFn = [&opts](spirv_cross::CompilerGLSL& compiler) {
         spirv_cross::CompilerGLSL::Options glslOpts = compiler.get_common_options();
         glslOpts.es = true;
         glslOpts.version = opts.Version;
         compiler.set_common_options(glslOpts);
     };
-    return spirvCompile<spirv_cross::CompilerGLSL>(initFn, this->parser->get_parsed_ir(), glsl, log);
+    return spirvCompile<spirv_cross::CompilerGLSL>(initFn, this->parser, this->retainIR, opts.Remap, glsl, log);
 }
 
 } // namespace shader_cross
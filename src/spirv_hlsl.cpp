@@ -3,13 +3,13 @@
 
 namespace shader_cross {
 
-bool SPIRVIR::ToHLSL(std::string* hlsl, const HLSLOptions& opts, std::string* log) const {
+bool SPIRVIR::ToHLSL(std::string* hlsl, const HLSLOptions& opts, std::string* log) {
     auto initFn = [&opts](spirv_cross::CompilerHLSL& compiler) {
         spirv_cross::CompilerHLSL::Options hlslOpts = compiler.get_hlsl_options();
         hlslOpts.shader_model = opts.Model;
         compiler.set_hlsl_options(hlslOpts);
     };
-    return spirvCompile<spirv_cross::CompilerHLSL>(initFn, this->parser->get_parsed_ir(), hlsl, log);
+    return spirvCompile<spirv_cross::CompilerHLSL>(initFn, this->parser, this->retainIR, opts.Remap, hlsl, log);
 }
 
 } // namespace shader_cross
@@ -0,0 +1,250 @@
+#include <shader_cross/shader_cross.hpp>
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace shader_cross {
+
+static const std::uint32_t spvMagicNumber = 0x07230203;
+static const std::size_t spvHeaderWords = 5;
+static const std::uint32_t spvOpTypeArray = 28;
+static const std::uint32_t spvOpTypeRuntimeArray = 29;
+static const std::uint32_t spvOpTypePointer = 32;
+static const std::uint32_t spvOpVariable = 59;
+static const std::uint32_t spvOpDecorate = 71;
+static const std::uint32_t spvOpMemberDecorate = 72;
+static const std::uint32_t spvOpDecorationGroup = 73;
+static const std::uint32_t spvOpGroupDecorate = 74;
+static const std::uint32_t spvOpGroupMemberDecorate = 75;
+static const std::uint32_t spvDecorationLocation = 30;
+static const std::uint32_t spvDecorationBinding = 33;
+static const std::uint32_t spvDecorationDescriptorSet = 34;
+static const std::uint32_t spvStorageClassInput = 1;
+static const std::uint32_t spvStorageClassOutput = 3;
+
+static const std::size_t noWord = std::size_t(-1);
+
+// Word offsets of the decoration operands to patch for one id
+struct DecoratedId {
+    std::size_t setWord = noWord;
+    std::size_t bindingWord = noWord;
+    std::size_t locationWord = noWord;
+    // DescriptorSet applied through a decoration group
+    std::size_t groupSetWord = noWord;
+    std::uint32_t storageClass = std::uint32_t(-1);
+    bool group = false;
+};
+
+// Member Location decorations of a struct, and the interfaces it is used by
+struct DecoratedStruct {
+    std::vector<std::size_t> locationWords;
+    bool input = false;
+    bool output = false;
+};
+
+static void appendError(std::string* log, const std::string& err) {
+    if (log) {
+        log->append(err);
+    }
+}
+
+static const DescriptorRemap* findDescriptorRemap(const RemapOptions& opts, std::uint32_t set, std::uint32_t binding) {
+    for (auto& remap : opts.Descriptors) {
+        if (remap.Set == set && remap.Binding == binding) {
+            return &remap;
+        }
+    }
+    return nullptr;
+}
+
+static const LocationRemap* findLocationRemap(const RemapOptions& opts, bool output, std::uint32_t location) {
+    for (auto& remap : opts.Locations) {
+        if (remap.Output == output && remap.Location == location) {
+            return &remap;
+        }
+    }
+    return nullptr;
+}
+
+static std::string idError(std::uint32_t id, const std::string& err) {
+    return "Can't remap id " + std::to_string(id) + ": " + err;
+}
+
+bool RemapSPIRV(std::uint32_t* spirv, std::size_t size, const RemapOptions& opts, std::string* log) {
+    if (size < spvHeaderWords || spirv[0] != spvMagicNumber) {
+        appendError(log, "Invalid SPIR-V module");
+        return false;
+    }
+    if (opts.Descriptors.empty() && opts.Locations.empty()) {
+        return true;
+    }
+    bool remapLocations = !opts.Locations.empty();
+    std::unordered_map<std::uint32_t, DecoratedId> ids;
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> groupTargets;
+    std::unordered_set<std::uint32_t> memberGroups;
+    std::unordered_map<std::uint32_t, DecoratedStruct> structs;
+    // Pointer and array types, to find the block struct of an interface variable
+    std::unordered_map<std::uint32_t, std::uint32_t> elementTypes;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> interfaceVariables;
+    for (std::size_t pos = spvHeaderWords; pos < size; ) {
+        std::uint32_t opcode = spirv[pos] & 0xffff;
+        std::size_t count = spirv[pos] >> 16;
+        if (count == 0 || pos + count > size) {
+            appendError(log, "Invalid SPIR-V instruction at word " + std::to_string(pos));
+            return false;
+        }
+        if (opcode == spvOpDecorate && count >= 4) {
+            std::uint32_t decoration = spirv[pos + 2];
+            if (decoration == spvDecorationDescriptorSet) {
+                ids[spirv[pos + 1]].setWord = pos + 3;
+            } else if (decoration == spvDecorationBinding) {
+                ids[spirv[pos + 1]].bindingWord = pos + 3;
+            } else if (decoration == spvDecorationLocation && remapLocations) {
+                ids[spirv[pos + 1]].locationWord = pos + 3;
+            }
+        } else if (opcode == spvOpMemberDecorate && count >= 5 && remapLocations) {
+            if (spirv[pos + 3] == spvDecorationLocation) {
+                structs[spirv[pos + 1]].locationWords.push_back(pos + 4);
+            }
+        } else if (opcode == spvOpDecorationGroup && count >= 2) {
+            ids[spirv[pos + 1]].group = true;
+        } else if (opcode == spvOpGroupDecorate && count >= 2) {
+            for (std::size_t i = 2; i < count; ++i) {
+                groupTargets[spirv[pos + 1]].push_back(spirv[pos + i]);
+                // Entry so the scan records the target's storage class
+                ids[spirv[pos + i]];
+            }
+        } else if (opcode == spvOpGroupMemberDecorate && count >= 2) {
+            memberGroups.insert(spirv[pos + 1]);
+        } else if ((opcode == spvOpTypeArray || opcode == spvOpTypeRuntimeArray) && count >= 3) {
+            elementTypes[spirv[pos + 1]] = spirv[pos + 2];
+        } else if (opcode == spvOpTypePointer && count >= 4) {
+            elementTypes[spirv[pos + 1]] = spirv[pos + 3];
+        } else if (opcode == spvOpVariable && count >= 4) {
+            auto it = ids.find(spirv[pos + 2]);
+            if (it != ids.end()) {
+                it->second.storageClass = spirv[pos + 3];
+            }
+            if (remapLocations && (spirv[pos + 3] == spvStorageClassInput || spirv[pos + 3] == spvStorageClassOutput)) {
+                interfaceVariables.emplace_back(spirv[pos + 1], spirv[pos + 3]);
+            }
+        }
+        pos += count;
+    }
+    for (auto& variable : interfaceVariables) {
+        std::uint32_t type = variable.first;
+        for (auto it = elementTypes.find(type); it != elementTypes.end(); it = elementTypes.find(type)) {
+            type = it->second;
+        }
+        auto it = structs.find(type);
+        if (it != structs.end()) {
+            (variable.second == spvStorageClassOutput ? it->second.output : it->second.input) = true;
+        }
+    }
+    for (auto& group : groupTargets) {
+        auto it = ids.find(group.first);
+        if (it == ids.end() || it->second.setWord == noWord) {
+            continue;
+        }
+        for (auto target : group.second) {
+            if (ids[target].setWord == noWord) {
+                ids[target].groupSetWord = it->second.setWord;
+            }
+        }
+    }
+    // Check before patching so a failed remap leaves the module untouched
+    for (auto& id : ids) {
+        const DecoratedId& decorated = id.second;
+        if (decorated.group) {
+            // Patching a group would move every target with it
+            if (decorated.bindingWord != noWord) {
+                std::uint32_t set = decorated.setWord != noWord ? spirv[decorated.setWord] : 0;
+                if (findDescriptorRemap(opts, set, spirv[decorated.bindingWord])) {
+                    appendError(log, idError(id.first, "binding is set through a decoration group"));
+                    return false;
+                }
+            }
+            if (decorated.locationWord != noWord) {
+                std::uint32_t location = spirv[decorated.locationWord];
+                bool matched = memberGroups.count(id.first) &&
+                    (findLocationRemap(opts, false, location) || findLocationRemap(opts, true, location));
+                for (auto target : groupTargets[id.first]) {
+                    std::uint32_t storageClass = ids.find(target)->second.storageClass;
+                    if ((storageClass == spvStorageClassInput || storageClass == spvStorageClassOutput) &&
+                            findLocationRemap(opts, storageClass == spvStorageClassOutput, location)) {
+                        matched = true;
+                    }
+                }
+                if (matched) {
+                    appendError(log, idError(id.first, "location is set through a decoration group"));
+                    return false;
+                }
+            }
+            continue;
+        }
+        if (decorated.bindingWord != noWord && decorated.setWord == noWord) {
+            std::uint32_t set = decorated.groupSetWord != noWord ? spirv[decorated.groupSetWord] : 0;
+            const DescriptorRemap* remap = findDescriptorRemap(opts, set, spirv[decorated.bindingWord]);
+            if (remap && remap->NewSet != set) {
+                appendError(log, idError(id.first, decorated.groupSetWord != noWord ?
+                    "DescriptorSet is set through a decoration group" :
+                    "no DescriptorSet decoration to move it to set " + std::to_string(remap->NewSet)));
+                return false;
+            }
+        }
+    }
+    for (auto& decoratedStruct : structs) {
+        if (decoratedStruct.second.input && decoratedStruct.second.output) {
+            for (auto word : decoratedStruct.second.locationWords) {
+                if (findLocationRemap(opts, false, spirv[word]) || findLocationRemap(opts, true, spirv[word])) {
+                    appendError(log, idError(decoratedStruct.first, "block type is shared by stage input and output"));
+                    return false;
+                }
+            }
+        }
+    }
+    // Patch after the scan so each id is matched against its original decorations
+    for (auto& id : ids) {
+        const DecoratedId& decorated = id.second;
+        if (decorated.group) {
+            continue;
+        }
+        if (decorated.bindingWord != noWord) {
+            std::uint32_t set = decorated.setWord != noWord ? spirv[decorated.setWord] :
+                decorated.groupSetWord != noWord ? spirv[decorated.groupSetWord] : 0;
+            const DescriptorRemap* remap = findDescriptorRemap(opts, set, spirv[decorated.bindingWord]);
+            if (remap) {
+                if (decorated.setWord != noWord) {
+                    spirv[decorated.setWord] = remap->NewSet;
+                }
+                spirv[decorated.bindingWord] = remap->NewBinding;
+            }
+        }
+        if (decorated.locationWord != noWord &&
+                (decorated.storageClass == spvStorageClassInput || decorated.storageClass == spvStorageClassOutput)) {
+            const LocationRemap* remap = findLocationRemap(opts, decorated.storageClass == spvStorageClassOutput, spirv[decorated.locationWord]);
+            if (remap) {
+                spirv[decorated.locationWord] = remap->NewLocation;
+            }
+        }
+    }
+    for (auto& decoratedStruct : structs) {
+        const DecoratedStruct& decorated = decoratedStruct.second;
+        if (decorated.input == decorated.output) {
+            continue;
+        }
+        for (auto word : decorated.locationWords) {
+            const LocationRemap* remap = findLocationRemap(opts, decorated.output, spirv[word]);
+            if (remap) {
+                spirv[word] = remap->NewLocation;
+            }
+        }
+    }
+    return true;
+}
+
+bool RemapSPIRV(std::vector<std::uint32_t>* spirv, const RemapOptions& opts, std::string* log) {
+    return RemapSPIRV(spirv->data(), spirv->size(), opts, log);
+}
+
+} // namespace shader_cross
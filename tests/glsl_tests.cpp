@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <shader_cross/shader_cross.hpp>
+#include <fstream>
 #include <string>
 
 class GLSLTest : public testing::Test {
@@ -11,8 +12,7 @@ protected:
     shader_cross::SPIRVIR spirvIR;
 };
 
-void GLSLTest::SetUp() {
-    std::string transformVSglsl = R"(#version 450
+static const std::string transformVSglsl = R"(#version 450
 out gl_PerVertex {
     vec4 gl_Position;
 };
@@ -24,6 +24,8 @@ void main() {
     gl_Position = cbVS.wvp * in_var_POSITION;
 }
 )";
+
+void GLSLTest::SetUp() {
     {
         shader_cross::GLSLAST::Options opts;
         opts.Stage = shader_cross::Stage::Vertex;
@@ -75,3 +77,225 @@ TEST_F(GLSLTest, ToMSL) {
     std::string log;
     ASSERT_TRUE(spirvIR.ToMSL(&msl, opts, &log)) << log;
 }
+
+TEST(GLSLPreprocessTest, Defines) {
+    std::string glsl = R"(#version 450
+layout(location = 0) out vec4 out_color;
+void main() {
+    out_color = vec4(SCALE);
+}
+)";
+    shader_cross::GLSLAST::Options opts;
+    opts.Stage = shader_cross::Stage::Fragment;
+    opts.Defines.push_back("SCALE=0.5");
+    std::string output;
+    std::string log;
+    ASSERT_TRUE(shader_cross::GLSLAST::Preprocess({ glsl }, opts, &output, &log)) << log;
+    EXPECT_EQ(output.find("SCALE"), std::string::npos) << output;
+    EXPECT_NE(output.find("0.5"), std::string::npos) << output;
+}
+
+TEST(GLSLPreprocessTest, ParsePreprocessed) {
+    {
+        std::ofstream ofs("glsl_tests_scale.glsl");
+        ofs << "const float kScale = SCALE;\n";
+    }
+    std::string glsl = R"(#version 450
+#include "glsl_tests_scale.glsl"
+layout(location = 0) out vec4 out_color;
+void main() {
+    out_color = vec4(kScale);
+}
+)";
+    shader_cross::GLSLAST::Options opts;
+    opts.Stage = shader_cross::Stage::Fragment;
+    opts.IncludeDirectories.push_back(".");
+    opts.Defines.push_back("SCALE=0.5");
+    std::string output;
+    std::string log;
+    ASSERT_TRUE(shader_cross::GLSLAST::Preprocess({ glsl }, opts, &output, &log)) << log;
+    // The output is parsed without the includer, defines or include extension
+    shader_cross::GLSLAST::Options preprocessedOpts;
+    preprocessedOpts.Stage = shader_cross::Stage::Fragment;
+    preprocessedOpts.EnableInclude = false;
+    preprocessedOpts.Preprocessed = true;
+    shader_cross::GLSLAST glslAST;
+    ASSERT_TRUE(glslAST.Parse({ output }, preprocessedOpts, &log)) << output << log;
+    std::vector<std::uint32_t> spirv;
+    ASSERT_TRUE(glslAST.ToSPIRV(&spirv, shader_cross::SPIRVOptions(), &log)) << log;
+}
+
+TEST(GLSLPreprocessTest, PreprocessCache) {
+    {
+        std::ofstream ofs("glsl_tests_color.glsl");
+        ofs << "#ifdef RED\nconst vec4 kColor = vec4(1.0, 0.0, 0.0, 1.0);\n#else\nconst vec4 kColor = vec4(0.0, 0.0, 1.0, 1.0);\n#endif\n";
+    }
+    std::string glsl = R"(#version 450
+#include "glsl_tests_color.glsl"
+layout(location = 0) out vec4 out_color;
+void main() {
+    out_color = kColor;
+}
+)";
+    shader_cross::PreprocessCache cache;
+    shader_cross::GLSLAST::Options opts;
+    opts.Stage = shader_cross::Stage::Fragment;
+    opts.IncludeDirectories.push_back(".");
+    opts.PreprocessCache = &cache;
+    auto compile = [&](const shader_cross::GLSLAST::Options& opts, std::string* glslOut) {
+        shader_cross::GLSLAST glslAST;
+        std::string log;
+        ASSERT_TRUE(glslAST.Parse({ glsl }, opts, &log)) << log;
+        std::vector<std::uint32_t> spirv;
+        ASSERT_TRUE(glslAST.ToSPIRV(&spirv, shader_cross::SPIRVOptions(), &log)) << log;
+        shader_cross::SPIRVIR spirvIR;
+        ASSERT_TRUE(spirvIR.Parse(spirv, &log)) << log;
+        ASSERT_TRUE(spirvIR.ToGLSL(glslOut, shader_cross::GLSLOptions(), &log)) << log;
+    };
+    std::string blue;
+    compile(opts, &blue);
+    EXPECT_NE(blue.find("vec4(0.0, 0.0, 1.0, 1.0)"), std::string::npos) << blue;
+    EXPECT_EQ(cache.Size(), 1u);
+    // Same unit and defines: parsed from the cached expansion
+    std::string blueAgain;
+    compile(opts, &blueAgain);
+    EXPECT_EQ(blueAgain, blue);
+    EXPECT_EQ(cache.Size(), 1u);
+    // Other defines are another expansion
+    opts.Defines.push_back("RED");
+    std::string red;
+    compile(opts, &red);
+    EXPECT_NE(red.find("vec4(1.0, 0.0, 0.0, 1.0)"), std::string::npos) << red;
+    EXPECT_EQ(cache.Size(), 2u);
+
+    // Preprocess returns the cached expansion
+    std::string output;
+    std::string log;
+    ASSERT_TRUE(shader_cross::GLSLAST::Preprocess({ glsl }, opts, &output, &log)) << log;
+    EXPECT_NE(output.find("1.0, 0.0, 0.0, 1.0"), std::string::npos) << output;
+    EXPECT_EQ(cache.Size(), 2u);
+    EXPECT_GT(cache.Bytes(), output.size());
+
+    // Failed expansions are not cached
+    std::string missing = "#version 450\n#include \"glsl_tests_missing.glsl\"\nvoid main() {}\n";
+    shader_cross::GLSLAST glslAST;
+    EXPECT_FALSE(glslAST.Parse({ missing }, opts, &log));
+    EXPECT_EQ(cache.Size(), 2u);
+
+    // Bounded caches keep the most recent expansion
+    shader_cross::PreprocessCache smallCache(1);
+    opts.PreprocessCache = &smallCache;
+    compile(opts, &red);
+    opts.Defines.clear();
+    compile(opts, &blue);
+    EXPECT_EQ(smallCache.Size(), 1u);
+    smallCache.Clear();
+    EXPECT_EQ(smallCache.Size(), 0u);
+    EXPECT_EQ(smallCache.Bytes(), 0u);
+}
+
+TEST(GLSLRemapTest, Remap) {
+    std::string glsl = R"(#version 450
+layout(std140, binding = 2) uniform Block {
+    vec4 scale;
+} block;
+layout(location = 0) in vec4 in_pos;
+layout(location = 0) out vec4 out_color;
+void main() {
+    gl_Position = in_pos * block.scale;
+    out_color = in_pos;
+}
+)";
+    shader_cross::GLSLAST glslAST;
+    std::vector<std::uint32_t> spirv;
+    {
+        shader_cross::GLSLAST::Options opts;
+        opts.Stage = shader_cross::Stage::Vertex;
+        std::string log;
+        ASSERT_TRUE(glslAST.Parse({ glsl }, opts, &log)) << log;
+        ASSERT_TRUE(glslAST.ToSPIRV(&spirv, shader_cross::SPIRVOptions(), &log)) << log;
+    }
+
+    shader_cross::RemapOptions remap;
+    shader_cross::DescriptorRemap descriptor;
+    descriptor.Binding = 2;
+    descriptor.NewBinding = 7;
+    remap.Descriptors.push_back(descriptor);
+    shader_cross::LocationRemap location;
+    location.Location = 0;
+    location.NewLocation = 3;
+    remap.Locations.push_back(location);
+
+    // Patched SPIR-V and backend remapping give the same layout
+    std::vector<std::uint32_t> patched = spirv;
+    std::string log;
+    ASSERT_TRUE(shader_cross::RemapSPIRV(&patched, remap, &log)) << log;
+    std::string patchedGlsl;
+    {
+        shader_cross::SPIRVIR spirvIR;
+        ASSERT_TRUE(spirvIR.Parse(patched, &log)) << log;
+        ASSERT_TRUE(spirvIR.ToGLSL(&patchedGlsl, shader_cross::GLSLOptions(), &log)) << log;
+    }
+    std::string remappedGlsl;
+    {
+        shader_cross::SPIRVIR spirvIR;
+        ASSERT_TRUE(spirvIR.Parse(spirv, &log)) << log;
+        shader_cross::GLSLOptions opts;
+        opts.Remap = remap;
+        ASSERT_TRUE(spirvIR.ToGLSL(&remappedGlsl, opts, &log)) << log;
+    }
+    EXPECT_EQ(patchedGlsl, remappedGlsl);
+    EXPECT_NE(patchedGlsl.find("binding = 7"), std::string::npos) << patchedGlsl;
+    EXPECT_NE(patchedGlsl.find("location = 3) in"), std::string::npos) << patchedGlsl;
+    EXPECT_NE(patchedGlsl.find("location = 0) out"), std::string::npos) << patchedGlsl;
+}
+
+TEST_F(GLSLTest, ReleaseIR) {
+    std::string glsl;
+    {
+        std::string log;
+        ASSERT_TRUE(spirvIR.ToGLSL(&glsl, shader_cross::GLSLOptions(), &log)) << log;
+    }
+
+    shader_cross::GLSLAST::Options astOpts;
+    astOpts.Stage = shader_cross::Stage::Vertex;
+    shader_cross::GLSLAST ast;
+    std::vector<std::uint32_t> spirv;
+    std::string log;
+    ASSERT_TRUE(ast.Parse({ transformVSglsl }, astOpts, &log)) << log;
+    ASSERT_TRUE(ast.ToSPIRV(&spirv, shader_cross::SPIRVOptions(), &log)) << log;
+    ast.Release();
+
+    // A non-retained IR compiles to the same output once
+    shader_cross::SPIRVIR compactIR;
+    shader_cross::SPIRVIR::Options irOpts;
+    irOpts.RetainIR = false;
+    ASSERT_TRUE(compactIR.Parse(std::move(spirv), irOpts, &log)) << log;
+    std::string compactGlsl;
+    ASSERT_TRUE(compactIR.ToGLSL(&compactGlsl, shader_cross::GLSLOptions(), &log)) << log;
+    EXPECT_EQ(glsl, compactGlsl);
+    log.clear();
+    EXPECT_FALSE(compactIR.ToGLSL(&compactGlsl, shader_cross::GLSLOptions(), &log));
+    EXPECT_FALSE(log.empty());
+    compactIR.Release();
+
+    // Released IRs don't compile
+    spirvIR.Release();
+    EXPECT_FALSE(spirvIR.ToGLSL(&glsl, shader_cross::GLSLOptions(), &log));
+}
+
+TEST(GLSLReleaseTest, ToSPIRVWithoutAST) {
+    shader_cross::GLSLAST glslAST;
+    shader_cross::GLSLAST::Options opts;
+    opts.Stage = shader_cross::Stage::Vertex;
+    std::vector<std::uint32_t> spirv;
+    std::string log;
+    EXPECT_FALSE(glslAST.ToSPIRV(&spirv, shader_cross::SPIRVOptions(), &log));
+    EXPECT_FALSE(glslAST.Parse({ "#version 450\nvoid main( {" }, opts, &log));
+    EXPECT_FALSE(glslAST.ToSPIRV(&spirv, shader_cross::SPIRVOptions(), &log));
+    ASSERT_TRUE(glslAST.Parse({ transformVSglsl }, opts, &log)) << log;
+    glslAST.Release();
+    log.clear();
+    EXPECT_FALSE(glslAST.ToSPIRV(&spirv, shader_cross::SPIRVOptions(), &log));
+    EXPECT_FALSE(log.empty());
+}
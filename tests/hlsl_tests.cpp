@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include <shader_cross/shader_cross.hpp>
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+class HLSLTest : public testing::Test {
+protected:
+    void SetUp() override;
+    void TearDown() override {}
+
+    shader_cross::HLSLAST hlslAST;
+    shader_cross::SPIRVIR spirvIR;
+};
+
+void HLSLTest::SetUp() {
+    std::string transformVShlsl = R"(cbuffer cbVS : register(b2) {
+    float4x4 wvp;
+};
+float4 VSMain(float4 pos : POSITION) : SV_Position {
+    return mul(pos, wvp);
+}
+)";
+    {
+        shader_cross::HLSLAST::Options opts;
+        opts.Stage = shader_cross::Stage::Vertex;
+        opts.EntryPoint = "VSMain";
+        opts.ShiftConstantBufferBinding = 16;
+        std::string log;
+        ASSERT_TRUE(hlslAST.Parse({ transformVShlsl }, opts, &log)) << log;
+    }
+
+    std::vector<std::uint32_t> spirv;
+    {
+        shader_cross::SPIRVOptions opts;
+        opts.Version = 13;
+        std::string log;
+        ASSERT_TRUE(hlslAST.ToSPIRV(&spirv, opts, &log)) << log;
+    }
+
+    {
+        std::string log;
+        ASSERT_TRUE(spirvIR.Parse(spirv, &log)) << log;
+    }
+}
+
+TEST_F(HLSLTest, ToGLSL) {
+    std::string glsl;
+    shader_cross::GLSLOptions opts;
+    opts.Version = 450;
+    std::string log;
+    ASSERT_TRUE(spirvIR.ToGLSL(&glsl, opts, &log)) << log;
+    EXPECT_NE(glsl.find("binding = 18"), std::string::npos) << glsl;
+}
+
+TEST_F(HLSLTest, ToESSL) {
+    std::string essl;
+    shader_cross::ESSLOptions opts;
+    opts.Version = 320;
+    std::string log;
+    ASSERT_TRUE(spirvIR.ToESSL(&essl, opts, &log)) << log;
+}
+
+TEST_F(HLSLTest, ToHLSL) {
+    std::string hlsl;
+    shader_cross::HLSLOptions opts;
+    opts.Model = 60;
+    std::string log;
+    ASSERT_TRUE(spirvIR.ToHLSL(&hlsl, opts, &log)) << log;
+}
+
+TEST_F(HLSLTest, ToMSL) {
+    std::string msl;
+    shader_cross::MSLOptions opts;
+    std::string log;
+    ASSERT_TRUE(spirvIR.ToMSL(&msl, opts, &log)) << log;
+}
+
+TEST(HLSLPreprocessTest, PreprocessCache) {
+    {
+        std::ofstream ofs("hlsl_tests_color.hlsli");
+        ofs << "#if __SHADER_TARGET_MAJOR >= 5\nstatic const float4 kColor = float4(COLOR, 1.0);\n#else\nstatic const float4 kColor = float4(0.0, 0.0, 0.0, 1.0);\n#endif\n";
+    }
+    std::string hlsl = R"(#include "hlsl_tests_color.hlsli"
+float4 PSMain() : SV_Target {
+    return kColor;
+}
+)";
+    shader_cross::PreprocessCache cache;
+    shader_cross::HLSLAST::Options opts;
+    opts.Stage = shader_cross::Stage::Fragment;
+    opts.EntryPoint = "PSMain";
+    opts.IncludeDirectories.push_back(".");
+    opts.Defines.push_back("COLOR=0.0, 1.0, 0.0");
+    opts.PreprocessCache = &cache;
+    // The shader model and defines are applied once, when the unit is expanded
+    for (int i = 0; i < 2; ++i) {
+        shader_cross::HLSLAST hlslAST;
+        std::string log;
+        ASSERT_TRUE(hlslAST.Parse({ hlsl }, opts, &log)) << log;
+        std::vector<std::uint32_t> spirv;
+        ASSERT_TRUE(hlslAST.ToSPIRV(&spirv, shader_cross::SPIRVOptions(), &log)) << log;
+        shader_cross::SPIRVIR spirvIR;
+        ASSERT_TRUE(spirvIR.Parse(spirv, &log)) << log;
+        std::string glsl;
+        ASSERT_TRUE(spirvIR.ToGLSL(&glsl, shader_cross::GLSLOptions(), &log)) << log;
+        EXPECT_NE(glsl.find("vec4(0.0, 1.0, 0.0, 1.0)"), std::string::npos) << glsl;
+    }
+    EXPECT_EQ(cache.Size(), 1u);
+}
+
+TEST(HLSLLegalizeTest, OpaqueThroughFunction) {
+    std::string hlsl = R"(Texture2D tex : register(t0);
+SamplerState samp : register(s0);
+float4 SampleWith(Texture2D t, SamplerState s, float2 uv) {
+    return t.Sample(s, uv);
+}
+float4 PSMain(float2 uv : TEXCOORD0) : SV_Target {
+    Texture2D local = tex;
+    return SampleWith(local, samp, uv);
+}
+)";
+    shader_cross::HLSLAST hlslAST;
+    shader_cross::HLSLAST::Options opts;
+    opts.Stage = shader_cross::Stage::Fragment;
+    opts.EntryPoint = "PSMain";
+    std::string log;
+    ASSERT_TRUE(hlslAST.Parse({ hlsl }, opts, &log)) << log;
+    std::vector<std::uint32_t> spirv;
+    ASSERT_TRUE(hlslAST.ToSPIRV(&spirv, shader_cross::SPIRVOptions(), &log)) << log;
+    shader_cross::SPIRVIR spirvIR;
+    ASSERT_TRUE(spirvIR.Parse(spirv, &log)) << log;
+    std::string glsl;
+    ASSERT_TRUE(spirvIR.ToGLSL(&glsl, shader_cross::GLSLOptions(), &log)) << log;
+    EXPECT_NE(glsl.find("texture("), std::string::npos) << glsl;
+    std::string msl;
+    ASSERT_TRUE(spirvIR.ToMSL(&msl, shader_cross::MSLOptions(), &log)) << log;
+}
+
+TEST(HLSLPreprocessTest, Defines) {
+    std::string hlsl = R"(float4 PSMain() : SV_Target {
+    return float4(COLOR, __SHADER_TARGET_MAJOR);
+}
+)";
+    shader_cross::HLSLAST::Options opts;
+    opts.Stage = shader_cross::Stage::Fragment;
+    opts.EntryPoint = "PSMain";
+    opts.ShaderModel = 51;
+    opts.Defines.push_back("COLOR=0.25, 0.5, 0.75");
+    std::string output;
+    std::string log;
+    ASSERT_TRUE(shader_cross::HLSLAST::Preprocess({ hlsl }, opts, &output, &log)) << log;
+    EXPECT_EQ(output.find("COLOR"), std::string::npos) << output;
+    EXPECT_EQ(output.find("__SHADER_TARGET_MAJOR"), std::string::npos) << output;
+    EXPECT_NE(output.find("0.25"), std::string::npos) << output;
+    EXPECT_NE(output.find("0.75"), std::string::npos) << output;
+}
+
+// Binding decoration operands, sorted
+static std::vector<std::uint32_t> bindingsOf(const std::vector<std::uint32_t>& spirv) {
+    std::vector<std::uint32_t> bindings;
+    for (std::size_t pos = 5; pos < spirv.size(); pos += spirv[pos] >> 16) {
+        if ((spirv[pos] & 0xffff) == 71 && spirv[pos + 2] == 33) {
+            bindings.push_back(spirv[pos + 3]);
+        }
+    }
+    std::sort(bindings.begin(), bindings.end());
+    return bindings;
+}
+
+static const std::string copyCShlsl = R"(Texture2D tex : register(t1);
+SamplerState samp : register(s0);
+RWTexture2D<float4> outTex : register(u2);
+[numthreads(8, 8, 1)]
+void CSMain(uint3 id : SV_DispatchThreadID) {
+    outTex[id.xy] = tex.SampleLevel(samp, float2(id.xy), 0);
+}
+)";
+
+TEST(HLSLBindingTest, Shifts) {
+    shader_cross::HLSLAST hlslAST;
+    shader_cross::HLSLAST::Options opts;
+    opts.Stage = shader_cross::Stage::Compute;
+    opts.EntryPoint = "CSMain";
+    opts.ShiftTextureBinding = 4;
+    opts.ShiftSamplerBinding = 8;
+    opts.ShiftUAVBinding = 12;
+    std::string log;
+    ASSERT_TRUE(hlslAST.Parse({ copyCShlsl }, opts, &log)) << log;
+    std::vector<std::uint32_t> spirv;
+    ASSERT_TRUE(hlslAST.ToSPIRV(&spirv, shader_cross::SPIRVOptions(), &log)) << log;
+    EXPECT_EQ(bindingsOf(spirv), std::vector<std::uint32_t>({ 5, 8, 14 }));
+}
+
+TEST(HLSLBindingTest, AutoMapBindings) {
+    std::string hlsl = R"(Texture2D tex;
+SamplerState samp;
+RWTexture2D<float4> outTex;
+[numthreads(8, 8, 1)]
+void CSMain(uint3 id : SV_DispatchThreadID) {
+    outTex[id.xy] = tex.SampleLevel(samp, float2(id.xy), 0);
+}
+)";
+    shader_cross::HLSLAST hlslAST;
+    shader_cross::HLSLAST::Options opts;
+    opts.Stage = shader_cross::Stage::Compute;
+    opts.EntryPoint = "CSMain";
+    opts.AutoMapBindings = true;
+    std::string log;
+    ASSERT_TRUE(hlslAST.Parse({ hlsl }, opts, &log)) << log;
+    std::vector<std::uint32_t> spirv;
+    ASSERT_TRUE(hlslAST.ToSPIRV(&spirv, shader_cross::SPIRVOptions(), &log)) << log;
+    std::vector<std::uint32_t> bindings = bindingsOf(spirv);
+    ASSERT_EQ(bindings.size(), 3u);
+    EXPECT_EQ(std::unique(bindings.begin(), bindings.end()), bindings.end());
+}
+
+TEST(HLSLReleaseTest, ToSPIRVWithoutProgram) {
+    shader_cross::HLSLAST hlslAST;
+    shader_cross::HLSLAST::Options opts;
+    opts.Stage = shader_cross::Stage::Compute;
+    opts.EntryPoint = "CSMain";
+    std::vector<std::uint32_t> spirv;
+    std::string log;
+    EXPECT_FALSE(hlslAST.ToSPIRV(&spirv, shader_cross::SPIRVOptions(), &log));
+    EXPECT_FALSE(hlslAST.Parse({ "void CSMain( {" }, opts, &log));
+    EXPECT_FALSE(hlslAST.ToSPIRV(&spirv, shader_cross::SPIRVOptions(), &log));
+    ASSERT_TRUE(hlslAST.Parse({ copyCShlsl }, opts, &log)) << log;
+    hlslAST.Release();
+    log.clear();
+    EXPECT_FALSE(hlslAST.ToSPIRV(&spirv, shader_cross::SPIRVOptions(), &log));
+    EXPECT_FALSE(log.empty());
+}
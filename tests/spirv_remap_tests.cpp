@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <shader_cross/shader_cross.hpp>
+#include <initializer_list>
+#include <vector>
+
+// Hand-built modules, so decorations glslang never emits (set-less resources,
+// decoration groups, member locations) are covered too.
+
+namespace {
+
+enum : std::uint32_t {
+    OpTypeArray = 28,
+    OpTypeStruct = 30,
+    OpTypePointer = 32,
+    OpVariable = 59,
+    OpDecorate = 71,
+    OpMemberDecorate = 72,
+    OpDecorationGroup = 73,
+    OpGroupDecorate = 74,
+    Location = 30,
+    Binding = 33,
+    DescriptorSet = 34,
+    Input = 1,
+    Uniform = 2,
+    Output = 3,
+};
+
+// Each instruction is its opcode followed by its operands
+std::vector<std::uint32_t> spirvModule(std::initializer_list<std::vector<std::uint32_t>> instructions) {
+    std::vector<std::uint32_t> words = { 0x07230203, 0x00010000, 0, 100, 0 };
+    for (auto& instruction : instructions) {
+        words.push_back(std::uint32_t(instruction.size() << 16) | instruction[0]);
+        words.insert(words.end(), instruction.begin() + 1, instruction.end());
+    }
+    return words;
+}
+
+shader_cross::RemapOptions descriptorRemap(std::uint32_t set, std::uint32_t binding, std::uint32_t newSet, std::uint32_t newBinding) {
+    shader_cross::DescriptorRemap remap;
+    remap.Set = set;
+    remap.Binding = binding;
+    remap.NewSet = newSet;
+    remap.NewBinding = newBinding;
+    shader_cross::RemapOptions opts;
+    opts.Descriptors.push_back(remap);
+    return opts;
+}
+
+shader_cross::RemapOptions locationRemap(bool output, std::uint32_t location, std::uint32_t newLocation) {
+    shader_cross::LocationRemap remap;
+    remap.Output = output;
+    remap.Location = location;
+    remap.NewLocation = newLocation;
+    shader_cross::RemapOptions opts;
+    opts.Locations.push_back(remap);
+    return opts;
+}
+
+} // namespace
+
+TEST(SPIRVRemapTest, Descriptors) {
+    auto spirv = spirvModule({
+        { OpDecorate, 10, DescriptorSet, 0 },
+        { OpDecorate, 10, Binding, 2 },
+        { OpVariable, 9, 10, Uniform },
+    });
+    std::string log;
+    ASSERT_TRUE(shader_cross::RemapSPIRV(&spirv, descriptorRemap(0, 2, 1, 7), &log)) << log;
+    EXPECT_EQ(spirv, spirvModule({
+        { OpDecorate, 10, DescriptorSet, 1 },
+        { OpDecorate, 10, Binding, 7 },
+        { OpVariable, 9, 10, Uniform },
+    }));
+}
+
+TEST(SPIRVRemapTest, SetlessDescriptor) {
+    auto spirv = spirvModule({
+        { OpDecorate, 10, Binding, 2 },
+        { OpVariable, 9, 10, Uniform },
+    });
+    // No DescriptorSet decoration to rewrite in place
+    auto unchanged = spirv;
+    std::string log;
+    EXPECT_FALSE(shader_cross::RemapSPIRV(&unchanged, descriptorRemap(0, 2, 1, 7), &log));
+    EXPECT_FALSE(log.empty());
+    EXPECT_EQ(unchanged, spirv);
+
+    ASSERT_TRUE(shader_cross::RemapSPIRV(&spirv, descriptorRemap(0, 2, 0, 7), &log)) << log;
+    EXPECT_EQ(spirv, spirvModule({
+        { OpDecorate, 10, Binding, 7 },
+        { OpVariable, 9, 10, Uniform },
+    }));
+}
+
+TEST(SPIRVRemapTest, Locations) {
+    auto spirv = spirvModule({
+        { OpDecorate, 10, Location, 0 },
+        { OpDecorate, 11, Location, 0 },
+        { OpVariable, 8, 10, Input },
+        { OpVariable, 9, 11, Output },
+    });
+    std::string log;
+    ASSERT_TRUE(shader_cross::RemapSPIRV(&spirv, locationRemap(false, 0, 3), &log)) << log;
+    EXPECT_EQ(spirv, spirvModule({
+        { OpDecorate, 10, Location, 3 },
+        { OpDecorate, 11, Location, 0 },
+        { OpVariable, 8, 10, Input },
+        { OpVariable, 9, 11, Output },
+    }));
+}
+
+TEST(SPIRVRemapTest, MemberLocations) {
+    // Output block, and an input array of the same layout as in geometry shaders
+    auto spirv = spirvModule({
+        { OpMemberDecorate, 20, 0, Location, 0 },
+        { OpMemberDecorate, 20, 1, Location, 1 },
+        { OpMemberDecorate, 30, 0, Location, 1 },
+        { OpTypeStruct, 20, 5, 5 },
+        { OpTypePointer, 21, Output, 20 },
+        { OpTypeStruct, 30, 5 },
+        { OpTypeArray, 31, 30, 6 },
+        { OpTypePointer, 32, Input, 31 },
+        { OpVariable, 21, 22, Output },
+        { OpVariable, 32, 33, Input },
+    });
+    auto remap = locationRemap(true, 1, 5);
+    remap.Locations.push_back(locationRemap(false, 1, 7).Locations[0]);
+    std::string log;
+    ASSERT_TRUE(shader_cross::RemapSPIRV(&spirv, remap, &log)) << log;
+    EXPECT_EQ(spirv[5 + 4], 0u);
+    EXPECT_EQ(spirv[5 + 5 + 4], 5u);
+    EXPECT_EQ(spirv[5 + 10 + 4], 7u);
+}
+
+TEST(SPIRVRemapTest, MemberLocationsSharedBlock) {
+    auto spirv = spirvModule({
+        { OpMemberDecorate, 20, 0, Location, 1 },
+        { OpTypeStruct, 20, 5 },
+        { OpTypePointer, 21, Output, 20 },
+        { OpTypePointer, 23, Input, 20 },
+        { OpVariable, 21, 22, Output },
+        { OpVariable, 23, 24, Input },
+    });
+    auto unchanged = spirv;
+    std::string log;
+    EXPECT_FALSE(shader_cross::RemapSPIRV(&unchanged, locationRemap(true, 1, 5), &log));
+    EXPECT_FALSE(log.empty());
+    EXPECT_EQ(unchanged, spirv);
+}
+
+TEST(SPIRVRemapTest, DecorationGroups) {
+    auto spirv = spirvModule({
+        { OpDecorate, 30, DescriptorSet, 1 },
+        { OpDecorate, 30, Binding, 4 },
+        { OpDecorationGroup, 30 },
+        { OpGroupDecorate, 30, 31, 32 },
+        { OpDecorate, 40, DescriptorSet, 1 },
+        { OpDecorationGroup, 40 },
+        { OpGroupDecorate, 40, 41 },
+        { OpDecorate, 41, Binding, 2 },
+    });
+    // The group's binding is shared by 31 and 32
+    auto unchanged = spirv;
+    std::string log;
+    EXPECT_FALSE(shader_cross::RemapSPIRV(&unchanged, descriptorRemap(1, 4, 1, 9), &log));
+    EXPECT_FALSE(log.empty());
+    EXPECT_EQ(unchanged, spirv);
+    // Own binding in a grouped set
+    log.clear();
+    EXPECT_FALSE(shader_cross::RemapSPIRV(&unchanged, descriptorRemap(1, 2, 0, 9), &log));
+    EXPECT_FALSE(log.empty());
+    EXPECT_EQ(unchanged, spirv);
+    ASSERT_TRUE(shader_cross::RemapSPIRV(&spirv, descriptorRemap(1, 2, 1, 9), &log)) << log;
+    EXPECT_EQ(spirv.back(), 9u);
+}
+
+TEST(SPIRVRemapTest, InvalidModule) {
+    std::vector<std::uint32_t> spirv = { 0x07230203, 0x00010000, 0, 100, 0, (5u << 16) | OpDecorate, 10, Binding };
+    std::string log;
+    EXPECT_FALSE(shader_cross::RemapSPIRV(&spirv, descriptorRemap(0, 2, 0, 3), &log));
+    EXPECT_FALSE(log.empty());
+}
@@ -0,0 +1,471 @@
+#include <gtest/gtest.h>
+#include <shader_cross/shader_cross.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+__pragma(comment(lib, "psapi.lib"))
+#endif // _MSC_VER
+#else
+#include <sys/resource.h>
+#endif // _WIN32
+
+// Procedurally generated corpora run through GLSLAST -> SPIRVIR -> every backend.
+// Set SHADER_CROSS_STRESS_SCALE to grow the corpus (e.g. 16 for multi-megabyte sources) and
+// SHADER_CROSS_STRESS_STRICT=1 to fail on timings instead of only reporting them.
+
+namespace {
+
+int stressScale() {
+    const char* env = std::getenv("SHADER_CROSS_STRESS_SCALE");
+    int scale = env ? std::atoi(env) : 0;
+    return scale > 0 ? scale : 1;
+}
+
+// Restarts the peak RSS measurement; false when only the process-wide peak is available.
+bool resetPeakRSS() {
+#ifdef __linux__
+    // Resets VmHWM, Linux 4.0+
+    std::ofstream ofs("/proc/self/clear_refs");
+    ofs << "5";
+    ofs.flush();
+    return bool(ofs);
+#else
+    return false;
+#endif // __linux__
+}
+
+#ifdef __linux__
+std::size_t procStatusKiB(const std::string& field) {
+    std::ifstream ifs("/proc/self/status");
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.compare(0, field.size(), field) == 0) {
+            return std::size_t(std::strtoull(line.c_str() + field.size(), nullptr, 10));
+        }
+    }
+    return 0;
+}
+#endif // __linux__
+
+// Current RSS, 0 where it isn't read
+std::size_t rssKiB() {
+#ifdef __linux__
+    return procStatusKiB("VmRSS:");
+#else
+    return 0;
+#endif // __linux__
+}
+
+std::size_t peakRSSKiB() {
+#ifdef __linux__
+    if (std::size_t peak = procStatusKiB("VmHWM:")) {
+        return peak;
+    }
+#endif // __linux__
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        return std::size_t(pmc.PeakWorkingSetSize / 1024);
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return std::size_t(usage.ru_maxrss / 1024);
+#else
+    return std::size_t(usage.ru_maxrss);
+#endif // __APPLE__
+#endif // _WIN32
+}
+
+bool stressStrict() {
+    const char* env = std::getenv("SHADER_CROSS_STRESS_STRICT");
+    return env && std::atoi(env) > 0;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const std::string& line) {
+    std::cout << "[ STRESS   ] " << line << std::endl;
+}
+
+// Peak RSS since resetPeakRSS() returned true, otherwise since the process started
+std::string peakRSSReport(bool scenario) {
+    return std::string(scenario ? "peak RSS " : "process peak RSS ") + std::to_string(peakRSSKiB()) + " KiB";
+}
+
+struct StressShader {
+    std::string Name;
+    shader_cross::Stage Stage = shader_cross::Stage::None;
+    std::string EntryPoint = "main";
+    std::vector<std::string> Sources;
+};
+
+std::string includeName(int depth, int index) {
+    return "stress_inc_" + std::to_string(depth) + "_" + std::to_string(index) + ".glsl";
+}
+
+std::string includeFunc(int depth, int index) {
+    return "stress_inc_" + std::to_string(depth) + "_" + std::to_string(index);
+}
+
+// Writes a diamond-shaped include DAG into the working directory: every header
+// of one level includes every header of the next, so guards are hit repeatedly.
+void writeIncludeTree(int depth, int width) {
+    for (int d = 0; d < depth; ++d) {
+        for (int i = 0; i < width; ++i) {
+            std::string guard = "STRESS_INC_" + std::to_string(d) + "_" + std::to_string(i);
+            std::string src;
+            src += "#ifndef " + guard + "\n#define " + guard + "\n";
+            if (d + 1 < depth) {
+                for (int j = 0; j < width; ++j) {
+                    src += "#include \"" + includeName(d + 1, j) + "\"\n";
+                }
+            }
+            src += "float " + includeFunc(d, i) + "(float x) {\n    float r = x * " + std::to_string(d + i + 1) + ".0;\n";
+            if (d + 1 < depth) {
+                for (int j = 0; j < width; ++j) {
+                    src += "    r += " + includeFunc(d + 1, j) + "(r);\n";
+                }
+            }
+            src += "    return r;\n}\n#endif\n";
+            std::ofstream ofs(includeName(d, i));
+            ofs << src;
+        }
+    }
+}
+
+std::string uniformBlock(int members) {
+    std::string src = "layout(std140, binding = 0) uniform StressBlock {\n";
+    for (int i = 0; i < members; ++i) {
+        src += (i % 2 ? "    float m" : "    vec4 m") + std::to_string(i) + ";\n";
+    }
+    src += "} ub;\n";
+    return src;
+}
+
+// Each statement reads `v` twice so the backends emit one temporary per statement
+// instead of forwarding a single ever-growing expression.
+std::string longBody(int statements, int members) {
+    std::string src;
+    for (int i = 0; i < statements; ++i) {
+        int m = (i % members) & ~1;
+        src += "    v = v * ub.m" + std::to_string(m) + " + v * " + std::to_string(i % 7 + 1) + ".0;\n";
+    }
+    return src;
+}
+
+StressShader vertexShader(const std::string& name, int members, int statements) {
+    StressShader shader;
+    shader.Name = name;
+    shader.Stage = shader_cross::Stage::Vertex;
+    std::string src = "#version 450\n";
+    src += uniformBlock(members);
+    src += "layout(location = 0) in vec4 in_pos;\nvoid main() {\n    vec4 v = in_pos;\n";
+    src += longBody(statements, members);
+    src += "    gl_Position = v;\n}\n";
+    shader.Sources.push_back(src);
+    return shader;
+}
+
+StressShader fragmentShader(const std::string& name, int members, int statements, int depth, int width) {
+    StressShader shader;
+    shader.Name = name;
+    shader.Stage = shader_cross::Stage::Fragment;
+    std::string src = "#version 450\n";
+    for (int i = 0; i < width && depth > 0; ++i) {
+        src += "#include \"" + includeName(0, i) + "\"\n";
+    }
+    src += uniformBlock(members);
+    src += "layout(location = 0) in vec4 in_color;\nlayout(location = 0) out vec4 out_color;\nvoid main() {\n    vec4 v = in_color;\n";
+    src += longBody(statements, members);
+    for (int i = 0; i < width && depth > 0; ++i) {
+        src += "    v.x += " + includeFunc(0, i) + "(v.y);\n";
+    }
+    src += "    out_color = v;\n}\n";
+    shader.Sources.push_back(src);
+    return shader;
+}
+
+StressShader computeShader(const std::string& name, const std::string& entryPoint, int members, int statements) {
+    StressShader shader;
+    shader.Name = name;
+    shader.Stage = shader_cross::Stage::Compute;
+    shader.EntryPoint = entryPoint;
+    // Split across several source strings to exercise the multi-string path.
+    shader.Sources.push_back("#version 450\nlayout(local_size_x = 64) in;\n");
+    shader.Sources.push_back(uniformBlock(members));
+    shader.Sources.push_back("layout(std430, binding = 1) buffer StressOut {\n    vec4 data[];\n} sb;\n");
+    shader.Sources.push_back("void " + entryPoint + "() {\n    vec4 v = vec4(gl_GlobalInvocationID.x);\n" + longBody(statements, members) +
+        "    sb.data[gl_GlobalInvocationID.x] = v;\n}\n");
+    return shader;
+}
+
+std::size_t sourceBytes(const StressShader& shader) {
+    std::size_t size = 0;
+    for (auto& src : shader.Sources) {
+        size += src.size();
+    }
+    return size;
+}
+
+bool compileAll(const StressShader& shader, std::string* log, shader_cross::PreprocessCache* preprocessCache = nullptr) {
+    shader_cross::GLSLAST glslAST;
+    shader_cross::SPIRVIR spirvIR;
+    {
+        shader_cross::GLSLAST::Options opts;
+        opts.Stage = shader.Stage;
+        opts.EntryPoint = shader.EntryPoint;
+        opts.IncludeDirectories.push_back(".");
+        opts.PreprocessCache = preprocessCache;
+        if (!glslAST.Parse(shader.Sources, opts, log)) {
+            return false;
+        }
+    }
+    std::vector<std::uint32_t> spirv;
+    if (!glslAST.ToSPIRV(&spirv, shader_cross::SPIRVOptions(), log)) {
+        return false;
+    }
+    if (!spirvIR.Parse(spirv, log)) {
+        return false;
+    }
+    std::string out;
+    return spirvIR.ToGLSL(&out, shader_cross::GLSLOptions(), log)
+        && spirvIR.ToESSL(&out, shader_cross::ESSLOptions(), log)
+        && spirvIR.ToHLSL(&out, shader_cross::HLSLOptions(), log)
+        && spirvIR.ToMSL(&out, shader_cross::MSLOptions(), log);
+}
+
+// Compiles every shader with `threads` workers; returns wall time in seconds.
+double compileCorpus(const std::vector<StressShader>& corpus, unsigned threads, std::atomic<int>* failures,
+        shader_cross::PreprocessCache* preprocessCache = nullptr) {
+    std::atomic<std::size_t> next(0);
+    auto worker = [&corpus, &next, failures, preprocessCache]() {
+        for (std::size_t i = next++; i < corpus.size(); i = next++) {
+            std::string log;
+            if (!compileAll(corpus[i], &log, preprocessCache)) {
+                ++*failures;
+                std::cerr << corpus[i].Name << ": " << log << std::endl;
+            }
+        }
+    };
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    return secondsSince(start);
+}
+
+} // namespace
+
+class StressTest : public testing::Test {
+protected:
+    static void SetUpTestCase() {
+        writeIncludeTree(kIncludeDepth, kIncludeWidth);
+    }
+
+    static const int kIncludeDepth = 6;
+    static const int kIncludeWidth = 3;
+
+    int scale = stressScale();
+};
+
+TEST_F(StressTest, SingleShaderKinds) {
+    bool scenarioRSS = resetPeakRSS();
+    std::vector<StressShader> corpus;
+    corpus.push_back(vertexShader("huge_uniform_block", 2048 * scale, 16));
+    corpus.push_back(fragmentShader("deep_includes", 8, 16, kIncludeDepth, kIncludeWidth));
+    corpus.push_back(fragmentShader("long_function", 8, 4096 * scale, 0, 0));
+    for (int i = 0; i < 8; ++i) {
+        std::string entry = "entry" + std::to_string(i);
+        corpus.push_back(computeShader("entry_point_" + std::to_string(i), entry, 16, 64));
+    }
+    for (auto& shader : corpus) {
+        std::string log;
+        auto start = std::chrono::steady_clock::now();
+        EXPECT_TRUE(compileAll(shader, &log)) << shader.Name << ": " << log;
+        report(shader.Name + ": " + std::to_string(sourceBytes(shader)) + " bytes, " +
+            std::to_string(secondsSince(start)) + " s");
+    }
+    report(peakRSSReport(scenarioRSS));
+}
+
+TEST_F(StressTest, ThreadScaling) {
+    bool scenarioRSS = resetPeakRSS();
+    std::vector<StressShader> corpus;
+    for (int i = 0; i < 48 * scale; ++i) {
+        std::string name = "corpus_" + std::to_string(i);
+        switch (i % 3) {
+        case 0:
+            corpus.push_back(vertexShader(name, 64 + i, 128));
+            break;
+        case 1:
+            corpus.push_back(fragmentShader(name, 32, 128 + i, kIncludeDepth, kIncludeWidth));
+            break;
+        default:
+            corpus.push_back(computeShader(name, "cs" + std::to_string(i), 32, 128));
+            break;
+        }
+    }
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    double baseline = 0;
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+        std::atomic<int> failures(0);
+        double seconds = compileCorpus(corpus, threads, &failures);
+        EXPECT_EQ(failures.load(), 0) << "threads=" << threads;
+        if (threads == 1) {
+            baseline = seconds;
+        }
+        report("threads=" + std::to_string(threads) + " shaders/s=" + std::to_string(corpus.size() / seconds) +
+            " speedup=" + std::to_string(baseline / seconds));
+        if (threads == maxThreads) {
+            break;
+        }
+    }
+    report(peakRSSReport(scenarioRSS));
+}
+
+TEST_F(StressTest, PreprocessCache) {
+    // Every unit is compiled twice, as for two targets: the second parse reuses the expansion.
+    std::vector<StressShader> corpus;
+    for (int i = 0; i < 16 * scale; ++i) {
+        corpus.push_back(fragmentShader("includes_" + std::to_string(i), 16, 64, kIncludeDepth, kIncludeWidth));
+    }
+    std::size_t units = corpus.size();
+    corpus.insert(corpus.end(), corpus.begin(), corpus.end());
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::atomic<int> failures(0);
+    double uncached = compileCorpus(corpus, threads, &failures);
+    shader_cross::PreprocessCache cache;
+    double cached = compileCorpus(corpus, threads, &failures, &cache);
+    EXPECT_EQ(failures.load(), 0);
+    EXPECT_EQ(cache.Size(), units);
+    report("preprocess cache: " + std::to_string(cache.Size()) + " units, " + std::to_string(cache.Bytes()) + " bytes, " +
+        std::to_string(uncached) + " s uncached, " + std::to_string(cached) + " s cached");
+}
+
+TEST_F(StressTest, SourceSizeScaling) {
+    // Doubling the source should roughly double the time. Above 2.3x per doubling (an
+    // exponent of 1.2) the growth is flagged: n log n stays well below it at these sizes.
+    const double kMaxDoublingRatio = 2.3;
+    const int kRuns = 3;
+    bool scenarioRSS = resetPeakRSS();
+    std::vector<double> logBytes;
+    std::vector<double> logSeconds;
+    double previous = 0;
+    for (int statements = 1024 * scale; statements <= 16384 * scale; statements *= 2) {
+        StressShader shader = fragmentShader("size_" + std::to_string(statements), 64, statements, 0, 0);
+        double best = 0;
+        for (int run = 0; run < kRuns; ++run) {
+            std::string log;
+            auto start = std::chrono::steady_clock::now();
+            ASSERT_TRUE(compileAll(shader, &log)) << shader.Name << ": " << log;
+            double seconds = secondsSince(start);
+            best = run == 0 ? seconds : std::min(best, seconds);
+        }
+        std::string line = std::to_string(sourceBytes(shader)) + " bytes: " + std::to_string(best) + " s";
+        if (previous > 0) {
+            double ratio = best / previous;
+            line += " (x" + std::to_string(ratio) + " per doubling, exponent " + std::to_string(std::log2(ratio)) + ")";
+            if (ratio > kMaxDoublingRatio) {
+                line += " super-linear";
+                if (stressStrict()) {
+                    ADD_FAILURE() << "x" << ratio << " per doubling at " << statements << " statements";
+                }
+            }
+        }
+        report(line);
+        logBytes.push_back(std::log(double(sourceBytes(shader))));
+        logSeconds.push_back(std::log(std::max(best, 1e-9)));
+        previous = best;
+    }
+    // Least squares slope of log(time) over log(size)
+    double meanX = 0;
+    double meanY = 0;
+    for (std::size_t i = 0; i < logBytes.size(); ++i) {
+        meanX += logBytes[i] / logBytes.size();
+        meanY += logSeconds[i] / logSeconds.size();
+    }
+    double covariance = 0;
+    double variance = 0;
+    for (std::size_t i = 0; i < logBytes.size(); ++i) {
+        covariance += (logBytes[i] - meanX) * (logSeconds[i] - meanY);
+        variance += (logBytes[i] - meanX) * (logBytes[i] - meanX);
+    }
+    double exponent = covariance / variance;
+    std::string line = "fitted exponent " + std::to_string(exponent);
+    if (exponent > std::log2(kMaxDoublingRatio)) {
+        line += " super-linear";
+        if (stressStrict()) {
+            ADD_FAILURE() << "time grows as size^" << exponent;
+        }
+    }
+    report(line);
+    report(peakRSSReport(scenarioRSS));
+}
+
+TEST_F(StressTest, MemoryPerByte) {
+    // Calibrates shaderx --memory-per-byte: peak RSS growth of a batch job (parse of the
+    // preprocessed unit, SPIR-V, retained IR, one backend) per preprocessed byte. Freed memory
+    // kept by the allocator hides growth, so run it alone with --gtest_filter for the final number.
+    std::vector<StressShader> corpus;
+    corpus.push_back(fragmentShader("deep_includes", 8, 16, kIncludeDepth, kIncludeWidth));
+    corpus.push_back(vertexShader("huge_uniform_block", 2048 * scale, 16));
+    corpus.push_back(fragmentShader("long_function", 8, 4096 * scale, 0, 0));
+    double maxBytesPerByte = 0;
+    for (auto& shader : corpus) {
+        shader_cross::GLSLAST::Options opts;
+        opts.Stage = shader.Stage;
+        opts.EntryPoint = shader.EntryPoint;
+        opts.IncludeDirectories.push_back(".");
+        std::string preprocessed;
+        std::string log;
+        ASSERT_TRUE(shader_cross::GLSLAST::Preprocess(shader.Sources, opts, &preprocessed, &log)) << shader.Name << ": " << log;
+        opts.Preprocessed = true;
+        if (!resetPeakRSS()) {
+            report("peak RSS can't be reset here, no calibration");
+            return;
+        }
+        std::size_t baseKiB = rssKiB();
+        {
+            shader_cross::GLSLAST glslAST;
+            ASSERT_TRUE(glslAST.Parse({ preprocessed }, opts, &log)) << shader.Name << ": " << log;
+            std::vector<std::uint32_t> spirv;
+            ASSERT_TRUE(glslAST.ToSPIRV(&spirv, shader_cross::SPIRVOptions(), &log)) << shader.Name << ": " << log;
+            shader_cross::SPIRVIR spirvIR;
+            ASSERT_TRUE(spirvIR.Parse(spirv, &log)) << shader.Name << ": " << log;
+            std::string out;
+            ASSERT_TRUE(spirvIR.ToGLSL(&out, shader_cross::GLSLOptions(), &log)) << shader.Name << ": " << log;
+        }
+        std::size_t peakKiB = peakRSSKiB();
+        std::size_t grownKiB = peakKiB - std::min(peakKiB, baseKiB);
+        double bytesPerByte = 1024.0 * grownKiB / preprocessed.size();
+        maxBytesPerByte = std::max(maxBytesPerByte, bytesPerByte);
+        report(shader.Name + ": " + std::to_string(preprocessed.size()) + " preprocessed bytes, peak +" +
+            std::to_string(grownKiB) + " KiB, " + std::to_string(bytesPerByte) + " bytes per byte");
+    }
+    report("memory per byte " + std::to_string(maxBytesPerByte));
+}